@@ -148,6 +148,12 @@ public:
   unsigned num_processors() const override;
   unsigned num_channels() const override;
 
+  // automorphism groups are cached process wide (and additionally on disk if
+  // an automorphisms cache directory is set) by canonical graph, such that
+  // they are not recomputed for isomorphic architecture graphs
+  static void clear_automorphisms_nauty_cache();
+  static unsigned long automorphisms_nauty_cache_hits();
+
 private:
   internal::PermGroup automorphisms_(
     AutomorphismOptions const *options,
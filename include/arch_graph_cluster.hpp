@@ -16,12 +16,19 @@ namespace mpsym
 class TaskMapping;
 class TaskMapping;
 
-namespace internal { class PermGroup; }
+namespace internal
+{
+
+class PermGroup;
+class SharedThreadPool;
+
+} // namespace internal
 
 class ArchGraphCluster : public ArchGraphSystem
 {
 public:
-  virtual ~ArchGraphCluster() = default;
+  ArchGraphCluster();
+  virtual ~ArchGraphCluster();
 
   std::string to_gap() const override;
   std::string to_json() const override;
@@ -80,12 +87,30 @@ private:
       subsystem->reset_repr();
   }
 
+  void prepare_repr_(ReprOptions const *options,
+                     internal::timeout::flag aborted) override
+  {
+    for (auto const &subsystem : _subsystems)
+      subsystem->prepare_repr(options, aborted);
+  }
+
   TaskMapping repr_(TaskMapping const &mapping,
                     ReprOptions const *options,
                     TMORs *orbits,
                     internal::timeout::flag aborted) override;
 
+  TaskMapping repr_parallel(TaskMapping const &mapping,
+                            ReprOptions const &options,
+                            internal::timeout::flag aborted);
+
+  // indices of all subsystems, grouped by subsystem object, subsystems added
+  // more than once must not be used by several threads at the same time
+  std::vector<std::vector<unsigned>> subsystem_groups() const;
+
   std::vector<std::shared_ptr<ArchGraphSystem>> _subsystems;
+
+  // shared by all (non-concurrent) calls to repr_parallel
+  std::shared_ptr<internal::SharedThreadPool> _repr_pool;
 };
 
 } // namespace mpsym
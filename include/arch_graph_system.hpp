@@ -1,15 +1,23 @@
 #ifndef GUARD_ARCH_GRAPH_SYSTEM_H
 #define GUARD_ARCH_GRAPH_SYSTEM_H
 
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_set>
+#include <vector>
 
 #include "bsgs.hpp"
+#include "orbit.hpp"
+#include "perm.hpp"
 #include "perm_group.hpp"
+#include "perm_matrix.hpp"
 #include "string.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
 #include "task_mapping_orbit.hpp"
 #include "timeout.hpp"
 
@@ -24,13 +32,16 @@ struct ReprOptions
     ITERATE,
     LOCAL_SEARCH,
     ORBITS,
+    BACKTRACK,
+    STABILIZER_CHAIN,
     AUTO = ITERATE
   };
 
   enum class Variant {
     LOCAL_SEARCH_BFS,
     LOCAL_SEARCH_DFS,
-    LOCAL_SEARCH_SA_LINEAR
+    LOCAL_SEARCH_SA_LINEAR,
+    LOCAL_SEARCH_MULTI_START
   };
 
   static ReprOptions fill_defaults(ReprOptions const *options)
@@ -44,12 +55,22 @@ struct ReprOptions
 
   unsigned offset = 0u;
 
+  // number of threads over which the subsystems of an ArchGraphCluster are
+  // distributed, zero means one per hardware thread
+  unsigned cluster_num_threads = 1u;
+
   bool match = true;
   bool optimize_symmetric = true;
 
   unsigned local_search_append_generators = 0u;
   unsigned local_search_sa_iterations = 100u;
   double local_search_sa_T_init = 1.0;
+
+  // number of (BFS) local searches started from random elements of the orbit,
+  // distributed over local_search_multi_start_num_threads threads (zero means
+  // one per hardware thread)
+  unsigned local_search_multi_start_climbers = 8u;
+  unsigned local_search_multi_start_num_threads = 0u;
 };
 
 class ArchGraphSystem
@@ -91,11 +112,23 @@ public:
   {
     _automorphisms_valid = false;
     _automorphisms_is_symmetric_valid = false;
+    _automorphisms_backtrack_valid = false;
+    _automorphisms_stabilizer_chain_valid = false;
   }
 
   virtual unsigned automorphisms_degree() const
   { return num_processors(); }
 
+  // if non-empty, automorphism groups are persistently stored in (and loaded
+  // from) this directory, files are named after a hash of to_json()
+  static void set_automorphisms_cache_dir(std::string const &dir)
+  { _automorphisms_cache_dir = dir; }
+
+  static std::string automorphisms_cache_dir()
+  { return _automorphisms_cache_dir; }
+
+  std::string automorphisms_cache_file() const;
+
   internal::BSGS::order_type num_automorphisms(
     AutomorphismOptions const *options = nullptr,
     internal::timeout::flag aborted = internal::timeout::unset())
@@ -106,8 +139,10 @@ public:
     internal::timeout::flag aborted = internal::timeout::unset())
   {
     if (!automorphisms_ready()) {
-      _automorphisms = automorphisms_(options, aborted);
+      _automorphisms = automorphisms_cached(options, aborted);
       _automorphism_generators = _automorphisms.generators().with_inverses();
+      _automorphism_generators_matrix =
+        internal::TransposedPermMatrix(_automorphism_generators);
       _automorphisms_valid = true;
     }
 
@@ -130,6 +165,13 @@ public:
   bool repr_ready() const
   { return repr_ready_(); }
 
+  // completes all lazily initialized state which repr depends on for the
+  // given options (e.g. symmetry detection), afterwards repr can be called
+  // with these options from several threads at the same time
+  void prepare_repr(
+    ReprOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
   void reset_repr()
   { reset_repr_(); }
 
@@ -153,13 +195,70 @@ public:
     if (!repr_ready_())
       init_repr();
 
-    auto representative(repr_(mapping, options, &orbits, aborted));
+    return repr_memo_(mapping, orbits, options, aborted);
+  }
 
-    auto ins(orbits.insert(representative));
+  // representatives[i] = repr(mappings[i]), computed by num_threads threads
+  // (zero means one per hardware thread)
+  void repr_batch(
+    TaskMapping const *mappings,
+    std::size_t num_mappings,
+    TaskMapping *representatives,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset())
+  {
+    repr_batch_(num_mappings,
+                [&](std::size_t i){ return mappings[i]; },
+                [&](std::size_t i, TaskMapping const &representative)
+                { representatives[i] = representative; },
+                nullptr, nullptr, options, num_threads, aborted);
+  }
 
-    return std::make_tuple(representative, ins.first, ins.second);
+  // as above but representatives are also inserted into orbits, orbit indices
+  // depend on the order in which threads finish
+  void repr_batch(
+    TaskMapping const *mappings,
+    std::size_t num_mappings,
+    TaskMapping *representatives,
+    TMORs &orbits,
+    unsigned *orbit_indices = nullptr,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset())
+  {
+    repr_batch_(num_mappings,
+                [&](std::size_t i){ return mappings[i]; },
+                [&](std::size_t i, TaskMapping const &representative)
+                { representatives[i] = representative; },
+                &orbits, orbit_indices, options, num_threads, aborted);
   }
 
+  // as above but mappings and representatives are stored row by row in flat
+  // buffers of num_mappings * mapping_size tasks, orbits (and orbit_indices)
+  // are optional
+  void repr_batch_flat(
+    unsigned const *mappings,
+    std::size_t num_mappings,
+    std::size_t mapping_size,
+    unsigned *representatives,
+    TMORs *orbits = nullptr,
+    unsigned *orbit_indices = nullptr,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // as above but mappings are read directly from a (memory mapped) task
+  // mapping file, representatives (and orbits and orbit_indices) are optional
+  void repr_batch(
+    TaskMappingView const &mappings,
+    TaskMapping *representatives,
+    TMORs *orbits = nullptr,
+    unsigned *orbit_indices = nullptr,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
 private:
   virtual internal::BSGS::order_type num_automorphisms_(
     AutomorphismOptions const *options,
@@ -170,8 +269,22 @@ private:
     AutomorphismOptions const *options,
     internal::timeout::flag aborted) = 0;
 
+  internal::PermGroup automorphisms_cached(
+    AutomorphismOptions const *options,
+    internal::timeout::flag aborted);
+
   bool automorphisms_symmetric(ReprOptions const *options);
 
+  void repr_batch_(std::size_t num_mappings,
+                   std::function<TaskMapping(std::size_t)> const &mapping,
+                   std::function<void(std::size_t,
+                                      TaskMapping const &)> const &store,
+                   TMORs *orbits,
+                   unsigned *orbit_indices,
+                   ReprOptions const *options,
+                   unsigned num_threads,
+                   internal::timeout::flag aborted);
+
   virtual void init_repr_(AutomorphismOptions const *,
                           internal::timeout::flag )
   {}
@@ -179,6 +292,9 @@ private:
   virtual bool repr_ready_() const
   { return automorphisms_ready(); }
 
+  virtual void prepare_repr_(ReprOptions const *options,
+                             internal::timeout::flag aborted);
+
   virtual void reset_repr_()
   { reset_automorphisms(); }
 
@@ -187,6 +303,14 @@ private:
                             TMORs *orbits,
                             internal::timeout::flag aborted);
 
+  // repr_ followed by insertion into orbits, bypassed for mappings found in
+  // the memo of orbits (if any)
+  std::tuple<TaskMapping, bool, unsigned> repr_memo_(
+    TaskMapping const &mapping,
+    TMORs &orbits,
+    ReprOptions const *options,
+    internal::timeout::flag aborted);
+
   static bool is_repr(TaskMapping const &tasks,
                       ReprOptions const *options,
                       TMORs *orbits)
@@ -208,12 +332,20 @@ private:
                               internal::timeout::flag aborted) const;
 
   TaskMapping min_elem_local_search(TaskMapping const &tasks,
-                                    ReprOptions const *options) const;
+                                    ReprOptions const *options,
+                                    internal::timeout::flag aborted) const;
 
   internal::PermSet local_search_augment_gens(ReprOptions const *options) const;
 
+  TaskMapping min_elem_local_search_multi_start(
+    TaskMapping const &tasks,
+    ReprOptions const *options,
+    TMORs *orbits,
+    internal::timeout::flag aborted) const;
+
   TaskMapping min_elem_local_search_sa(TaskMapping const &tasks,
-                                       ReprOptions const *options) const;
+                                       ReprOptions const *options,
+                                       internal::timeout::flag aborted) const;
 
   static double local_search_sa_schedule_T(unsigned i,
                                            ReprOptions const *options);
@@ -225,8 +357,39 @@ private:
   TaskMapping min_elem_symmetric(TaskMapping const &tasks,
                                  ReprOptions const *options) const;
 
+  TaskMapping min_elem_backtrack(TaskMapping const &tasks,
+                                 ReprOptions const *options,
+                                 internal::timeout::flag aborted);
+
+  void min_elem_backtrack_init();
+
+  TaskMapping min_elem_stabilizer_chain(TaskMapping const &tasks,
+                                        ReprOptions const *options,
+                                        internal::timeout::flag aborted);
+
+  void min_elem_stabilizer_chain_init();
+
+  void min_elem_backtrack_search(TaskMapping const &tasks,
+                                 ReprOptions const *options,
+                                 unsigned level,
+                                 internal::Perm const &partial,
+                                 TaskMapping &representative,
+                                 internal::timeout::flag aborted) const;
+
+  TaskMapping min_elem_backtrack_bound(TaskMapping const &tasks,
+                                       ReprOptions const *options,
+                                       unsigned level,
+                                       internal::Perm const &partial,
+                                       bool &exact) const;
+
+  static std::string _automorphisms_cache_dir;
+
+  // serializes prepare_repr, shared between copies
+  std::shared_ptr<std::mutex> _repr_mtx = std::make_shared<std::mutex>();
+
   internal::PermGroup _automorphisms;
   internal::PermSet _automorphism_generators;
+  internal::TransposedPermMatrix _automorphism_generators_matrix;
 
   bool _automorphisms_valid = false;
 
@@ -235,6 +398,20 @@ private:
 
   unsigned _automorphisms_smp;
   unsigned _automorphisms_lmp;
+
+  // transversals of all levels of the automorphism group's stabilizer chain
+  // and the orbits of the stabilizer below each level
+  bool _automorphisms_backtrack_valid = false;
+
+  std::vector<std::vector<internal::Perm>> _automorphisms_backtrack_transversals;
+  std::vector<internal::OrbitPartition> _automorphisms_backtrack_orbits;
+
+  // BSGS of the automorphism group with schreier tree transversals (copied
+  // and rebased for every representative) and the points it moves
+  bool _automorphisms_stabilizer_chain_valid = false;
+
+  internal::BSGS _automorphisms_stabilizer_chain;
+  std::vector<bool> _automorphisms_stabilizer_chain_moved;
 };
 
 } // namespace mpsym
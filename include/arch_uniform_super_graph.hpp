@@ -6,7 +6,6 @@
 #include <string>
 #include <vector>
 
-#include "arch_graph_automorphisms.hpp"
 #include "arch_graph_system.hpp"
 #include "bsgs.hpp"
 #include "perm_group.hpp"
@@ -58,29 +57,16 @@ private:
 
   void reset_repr_() override;
 
+  void prepare_repr_(ReprOptions const *options,
+                     internal::timeout::flag aborted) override;
+
   TaskMapping repr_(TaskMapping const &mapping_,
                     ReprOptions const *options,
                     TMORs *orbits,
                     internal::timeout::flag aborted) override;
 
-  std::shared_ptr<internal::ArchGraphAutomorphisms>
-  wreath_product_action_super_graph(AutomorphismOptions const *options,
-                                    internal::timeout::flag aborted) const;
-
-  std::vector<std::shared_ptr<internal::ArchGraphAutomorphisms>>
-  wreath_product_action_proto(AutomorphismOptions const *options,
-                              internal::timeout::flag aborted) const;
-
   std::shared_ptr<ArchGraphSystem> _subsystem_super_graph;
   std::shared_ptr<ArchGraphSystem> _subsystem_proto;
-
-  bool _super_graph_trivial = false;
-  bool _proto_trivial = false;
-
-  std::shared_ptr<internal::ArchGraphAutomorphisms> _sigma_total;
-  std::shared_ptr<internal::ArchGraphAutomorphisms> _sigma_super_graph;
-  std::vector<std::shared_ptr<internal::ArchGraphAutomorphisms>> _sigmas_proto;
-  bool _sigmas_valid = false;
 };
 
 } // namespace mpsym
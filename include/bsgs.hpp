@@ -2,6 +2,7 @@
 #define GUARD_BSGS_H
 
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
@@ -13,6 +14,7 @@
 #include <boost/multiprecision/cpp_int.hpp>
 
 #include "perm_set.hpp"
+#include "thread_pool.hpp"
 #include "timeout.hpp"
 
 namespace mpsym
@@ -23,7 +25,10 @@ namespace internal
 
 class Orbit;
 class Perm;
+class PrRandomizer;
+class SchreierGeneratorQueue;
 class SchreierStructure;
+class TransversalCache;
 
 class BSGSTransversalsBase
 {
@@ -42,12 +47,19 @@ public:
   void insert_schreier_structure(
     unsigned i, unsigned root, unsigned degree, PermSet const &generators);
 
+  void push_schreier_structure(std::shared_ptr<SchreierStructure> ss)
+  { _schreier_structures.push_back(ss); }
+
   void clear()
   { _schreier_structures.clear(); }
 
   virtual std::shared_ptr<SchreierStructure> make_schreier_structure(
     unsigned root, unsigned degree, PermSet const &generators) = 0;
 
+  // schreier structures are never modified once they have been built, so
+  // they can still be shared by the copy
+  virtual std::shared_ptr<BSGSTransversalsBase> clone() const = 0;
+
 private:
   std::vector<std::shared_ptr<SchreierStructure>> _schreier_structures;
 };
@@ -58,12 +70,37 @@ class BSGSTransversals : public BSGSTransversalsBase
 public:
   virtual ~BSGSTransversals() = default;
 
+  std::shared_ptr<BSGSTransversalsBase> clone() const override
+  { return std::make_shared<BSGSTransversals<T>>(*this); }
+
 private:
   std::shared_ptr<SchreierStructure> make_schreier_structure(
     unsigned root, unsigned degree, PermSet const &generators) override
   { return std::make_shared<T>(degree, root, generators); }
 };
 
+class BSGSCachedTransversals : public BSGSTransversalsBase
+{
+public:
+  explicit BSGSCachedTransversals(std::shared_ptr<TransversalCache> cache)
+  : _cache(cache)
+  {}
+
+  virtual ~BSGSCachedTransversals() = default;
+
+  std::shared_ptr<TransversalCache> cache() const
+  { return _cache; }
+
+  std::shared_ptr<BSGSTransversalsBase> clone() const override
+  { return std::make_shared<BSGSCachedTransversals>(*this); }
+
+private:
+  std::shared_ptr<SchreierStructure> make_schreier_structure(
+    unsigned root, unsigned degree, PermSet const &generators) override;
+
+  std::shared_ptr<TransversalCache> _cache;
+};
+
 struct BSGSOptions;
 
 class BSGS
@@ -110,18 +147,51 @@ public:
   unsigned base_point(unsigned i) const { return _base[i]; }
   void base_change(std::vector<unsigned> prefix);
 
+  // copies of a BSGS share their transversals, base changes performed on the
+  // returned copy leave this BSGS untouched
+  BSGS unshared() const;
+
   PermSet strong_generators() const { return _strong_generators; }
   PermSet strong_generators(unsigned i) const;
 
   Orbit orbit(unsigned i) const;
   Perm transversal(unsigned i, unsigned o) const;
   PermSet transversals(unsigned i) const;
+  std::shared_ptr<TransversalCache> transversals_cache() const;
   PermSet stabilizers(unsigned i) const;
 
   std::pair<Perm, unsigned> strip(Perm const &perm, unsigned offs = 0) const;
-  bool strips_completely(Perm const &perm) const;
+  bool strips_completely(Perm const &perm, unsigned offs = 0) const;
+
+  // binary (de)serialization, load memory maps file and uses the stored
+  // strong generators and schreier trees without copying or parsing them, it
+  // fails unless key is equal to the one the file was saved with or the
+  // file's checksum does not match, verify additionally checks that all
+  // stored permutations and schreier trees are well-formed (which is slow
+  // and only needed for files not written by save)
+  void save(std::string const &file, std::string const &key = "") const;
+
+  static BSGS load(std::string const &file,
+                   std::string const &key = "",
+                   bool verify = false);
 
 private:
+  // scratch space reused by all strips performed by the same thread
+  struct StripBuffers
+  {
+    std::vector<unsigned> base_images;
+    std::vector<unsigned> betas;
+    std::vector<unsigned> images;
+  };
+
+  // strips the base images of perm and stores the orbit points it passes
+  // through in betas, returns the level at which this fails (or base_size())
+  unsigned strip_base_images(Perm const &perm,
+                             unsigned offs,
+                             std::vector<unsigned> &betas) const;
+
+  static StripBuffers &strip_buffers();
+
   // transversal initialization
   void transversals_init(BSGSOptions const *options);
 
@@ -139,15 +209,32 @@ private:
 
   void schreier_sims(std::vector<PermSet> &strong_generators,
                      std::vector<Orbit> &fundamental_orbits,
+                     SharedThreadPool::Lease const *thread_pool,
                      BSGSOptions const *options,
                      timeout::flag aborted);
 
+  bool schreier_sims_sift(SchreierGeneratorQueue &schreier_generator_queue,
+                          unsigned i,
+                          Perm &strip_perm,
+                          unsigned &strip_level) const;
+
+  bool schreier_sims_sift_parallel(
+    SchreierGeneratorQueue &schreier_generator_queue,
+    unsigned i,
+    unsigned batch_size,
+    SharedThreadPool::Lease const &thread_pool,
+    Perm &strip_perm,
+    unsigned &strip_level,
+    timeout::flag aborted) const;
+
   void schreier_sims_random(PermSet const &generators,
                             BSGSOptions const *options,
                             timeout::flag aborted);
 
   void schreier_sims_random(std::vector<PermSet> &strong_generators,
                             std::vector<Orbit> &fundamental_orbits,
+                            std::vector<PrRandomizer> &randomizers,
+                            SharedThreadPool::Lease const *thread_pool,
                             BSGSOptions const *options,
                             timeout::flag aborted);
 
@@ -219,6 +306,9 @@ private:
 
   bool _is_symmetric = false;
   bool _is_alternating = false;
+
+  // keeps the file mapped which loaded strong generators refer to
+  std::shared_ptr<void const> _data;
 };
 
 std::ostream &operator<<(std::ostream &os, BSGS const &bsgs);
@@ -229,13 +319,15 @@ struct BSGSOptions
     AUTO,
     SCHREIER_SIMS,
     SCHREIER_SIMS_RANDOM,
+    SCHREIER_SIMS_PARALLEL,
     SOLVE
   };
 
   enum class Transversals {
     EXPLICIT,
     SCHREIER_TREES,
-    SHALLOW_SCHREIER_TREES
+    SHALLOW_SCHREIER_TREES,
+    CACHED
   };
 
   static BSGSOptions fill_defaults(BSGSOptions const *options)
@@ -247,6 +339,11 @@ struct BSGSOptions
   Construction construction = Construction::AUTO;
   Transversals transversals = Transversals::EXPLICIT;
 
+  // only used for Transversals::CACHED, if no cache is given a new one
+  // holding at most transversals_cache_bytes bytes is created
+  std::size_t transversals_cache_bytes = 1u << 26;
+  std::shared_ptr<TransversalCache> transversals_cache;
+
   bool check_sym = true;
   bool reduce_gens = true;
 
@@ -255,6 +352,16 @@ struct BSGSOptions
   BSGS::order_type schreier_sims_random_known_order = 0;
   int schreier_sims_random_retries = -1;
   unsigned schreier_sims_random_w = 100u;
+
+  // random elements are drawn from one product replacement stream per
+  // thread, stream i is seeded with (seed, i) unless seed is negative
+  int schreier_sims_random_seed = -1;
+  unsigned schreier_sims_random_num_threads = 1u;
+
+  // threads are taken from a pool shared by all constructions, constructions
+  // running while it is in use by another one are not parallelized
+  unsigned schreier_sims_parallel_num_threads = 0u;
+  unsigned schreier_sims_parallel_batch_size = 64u;
 };
 
 } // namespace internal
@@ -0,0 +1,131 @@
+#ifndef GUARD_CACHED_TRANSVERSALS_H
+#define GUARD_CACHED_TRANSVERSALS_H
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "schreier_structure.hpp"
+#include "schreier_tree.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// least recently used transversals of any number of CachedTransversals
+// objects, evicts transversals once they take up more than max_bytes
+class TransversalCache
+{
+public:
+  using key_type = std::pair<unsigned long, unsigned>;
+
+  explicit TransversalCache(std::size_t max_bytes);
+
+  std::size_t max_bytes() const { return _max_bytes; }
+  std::size_t bytes() const;
+  std::size_t size() const;
+
+  unsigned long hits() const { return _hits; }
+  unsigned long misses() const { return _misses; }
+
+  bool find(key_type const &key, Perm &perm);
+  void insert(key_type const &key, Perm const &perm);
+
+  void clear();
+
+  static std::size_t perm_bytes(Perm const &perm);
+
+private:
+  struct KeyHash
+  {
+    std::size_t operator()(key_type const &key) const;
+  };
+
+  using entry_type = std::pair<key_type, Perm>;
+
+  std::size_t _max_bytes;
+  std::size_t _bytes;
+
+  std::list<entry_type> _entries;
+  std::unordered_map<key_type,
+                     std::list<entry_type>::iterator,
+                     KeyHash> _index;
+
+  std::atomic<unsigned long> _hits;
+  std::atomic<unsigned long> _misses;
+
+  mutable std::mutex _mtx;
+};
+
+// transversals are stored implicitly in a schreier tree, those requested
+// recently are also stored explicitly in a (possibly shared) TransversalCache
+struct CachedTransversals : public SchreierStructure
+{
+  CachedTransversals(unsigned degree,
+                     unsigned root,
+                     PermSet const &labels,
+                     std::shared_ptr<TransversalCache> cache);
+
+  virtual ~CachedTransversals() = default;
+
+  void add_label(Perm const &label) override
+  { _tree.add_label(label); }
+
+  void create_edge(unsigned origin,
+                   unsigned destination,
+                   unsigned label) override;
+
+  unsigned root() const override
+  { return _root; }
+
+  std::vector<unsigned> nodes() const override
+  { return _tree.nodes(); }
+
+  PermSet labels() const override
+  { return _tree.labels(); }
+
+  bool contains(unsigned node) const override
+  { return _tree.contains(node); }
+
+  bool incoming(unsigned node, Perm const &edge) const override
+  { return _tree.incoming(node, edge); }
+
+  Perm transversal(unsigned origin) const override;
+
+  // walks the tree, which is cheaper than looking up the whole transversal
+  void transversal_apply_inverse(unsigned origin,
+                                 unsigned *first,
+                                 unsigned *last) const override
+  { _tree.transversal_apply_inverse(origin, first, last); }
+
+  std::shared_ptr<TransversalCache> cache() const
+  { return _cache; }
+
+private:
+  void dump(std::ostream &os) const override
+  { os << "cached " << _tree; }
+
+  unsigned _degree;
+  unsigned _root;
+
+  SchreierTree _tree;
+
+  std::shared_ptr<TransversalCache> _cache;
+  unsigned long _id;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_CACHED_TRANSVERSALS_H
@@ -40,6 +40,10 @@ struct ExplicitTransversals : public SchreierStructure
   bool incoming(unsigned node, Perm const &edge) const override;
   Perm transversal(unsigned origin) const override;
 
+  void transversal_apply_inverse(unsigned origin,
+                                 unsigned *first,
+                                 unsigned *last) const override;
+
 private:
   void dump(std::ostream &os) const override;
 
@@ -1,7 +1,9 @@
 #ifndef GUARD_HASH_H
 #define GUARD_HASH_H
 
+#include <cstdint>
 #include <iterator>
+#include <string>
 
 namespace mpsym
 {
@@ -26,6 +28,19 @@ struct ContainerHash
   { return util::container_hash(c.begin(), c.end()); }
 };
 
+// 64-bit FNV-1a, unlike std::hash this is stable across implementations
+inline uint64_t stable_hash(std::string const &str)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+
+  return hash;
+}
+
 } // namespace util
 
 } // namespace mpsym
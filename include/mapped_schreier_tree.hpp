@@ -0,0 +1,96 @@
+#ifndef GUARD_MAPPED_SCHREIER_TREE_H
+#define GUARD_MAPPED_SCHREIER_TREE_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "schreier_structure.hpp"
+#include "schreier_tree.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// schreier tree stored in flat arrays inside a (memory mapped) buffer that is
+// kept alive by data, see BSGS::save for the layout, the tree is copied into a
+// writable schreier tree (and the buffer released) once it is first modified
+struct MappedSchreierTree : public SchreierStructure
+{
+  static constexpr uint32_t NO_EDGE = UINT32_MAX;
+
+  MappedSchreierTree(unsigned degree,
+                     unsigned root,
+                     unsigned num_labels,
+                     uint32_t const *labels,
+                     uint32_t const *inverse_labels,
+                     uint32_t const *edges,
+                     uint32_t const *edge_labels,
+                     std::shared_ptr<void const> data)
+  : _degree(degree),
+    _root(root),
+    _num_labels(num_labels),
+    _labels(labels),
+    _inverse_labels(inverse_labels),
+    _edges(edges),
+    _edge_labels(edge_labels),
+    _data(data)
+  {}
+
+  virtual ~MappedSchreierTree() = default;
+
+  void add_label(Perm const &label) override
+  { writable()->add_label(label); }
+
+  void create_edge(unsigned origin,
+                   unsigned destination,
+                   unsigned label) override
+  { writable()->create_edge(origin, destination, label); }
+
+  unsigned root() const override;
+  std::vector<unsigned> nodes() const override;
+  PermSet labels() const override;
+
+  bool contains(unsigned node) const override;
+  bool incoming(unsigned node, Perm const &edge) const override;
+  Perm transversal(unsigned origin) const override;
+
+  void transversal_apply_inverse(unsigned origin,
+                                 unsigned *first,
+                                 unsigned *last) const override;
+
+private:
+  void dump(std::ostream &os) const override;
+
+  SchreierTree *writable();
+
+  uint32_t const *label(unsigned i) const
+  { return _labels + i * _degree; }
+
+  uint32_t const *inverse_label(unsigned i) const
+  { return _inverse_labels + i * _degree; }
+
+  unsigned _degree;
+  unsigned _root;
+  unsigned _num_labels;
+
+  uint32_t const *_labels;
+  uint32_t const *_inverse_labels;
+  uint32_t const *_edges;
+  uint32_t const *_edge_labels;
+
+  std::shared_ptr<void const> _data;
+
+  std::unique_ptr<SchreierTree> _tree;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_MAPPED_SCHREIER_TREE_H
@@ -6,6 +6,7 @@
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
 #include "task_mapping_orbit.hpp"
 
 #endif // GUARD_MPSYM_H
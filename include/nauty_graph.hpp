@@ -34,7 +34,18 @@ public:
 
   PermSet automorphism_generators();
 
+  // additionally determines a canonical labeling, i.e. vertex
+  // canonical_labeling[i] of this graph corresponds to vertex i of the
+  // canonical graph, and a string representation of the canonical graph which
+  // is identical for all isomorphic graphs (with isomorphic partitions)
+  PermSet automorphism_generators(std::vector<int> &canonical_labeling,
+                                  std::string &canonical_graph);
+
 private:
+  PermSet automorphism_generators(bool canonical);
+
+  std::string canonical_graph() const;
+
   bool _directed;
   int _n, _n_reduced;
   int *_lab, *_ptn, *_orbits;
@@ -2,7 +2,9 @@
 #define GUARD_PERM_H
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <vector>
 
@@ -40,15 +42,37 @@ namespace internal
 class Perm : boost::operators<Perm>
 {
 friend std::size_t std::hash<Perm>::operator()(Perm const &perm) const;
+friend class PermMatrix;
 
 public:
+  // permutations up to this degree store their images inline
+  static constexpr unsigned SMALL_DEGREE = 64u;
+
   explicit Perm(unsigned degree = 1);
 
   explicit Perm(std::vector<unsigned> const &perm);
 
   Perm(unsigned degree, std::vector<std::vector<unsigned>> const &cycles);
 
-  unsigned const& operator[](unsigned const x) const;
+  // permutation of degree larger than SMALL_DEGREE which refers to instead of
+  // copying images, these must outlive it and every permutation it is moved
+  // to, copies and modified permutations own their images
+  static Perm borrowed(unsigned degree, unsigned const *images);
+
+  Perm(Perm const &other);
+  Perm(Perm &&other) noexcept;
+
+  ~Perm();
+
+  Perm &operator=(Perm const &rhs);
+  Perm &operator=(Perm &&rhs) noexcept;
+
+  unsigned operator[](unsigned const x) const
+  {
+    assert(x < degree());
+    return small() ? _perm_small[x] : _perm_large[x];
+  }
+
   Perm operator~() const;
   bool operator==(Perm const &rhs) const;
   bool operator<(Perm const &rhs) const;
@@ -99,13 +123,42 @@ public:
   }
 
   std::vector<unsigned> vect() const
-  { return std::vector<unsigned>(_perm.begin(), _perm.end()); }
+  {
+    if (small())
+      return std::vector<unsigned>(_perm_small, _perm_small + _degree);
+
+    return std::vector<unsigned>(_perm_large, _perm_large + _degree);
+  }
 
   std::vector<std::vector<unsigned>> cycles() const;
 
 private:
+  bool small() const
+  { return _degree <= SMALL_DEGREE; }
+
+  void set(unsigned x, unsigned y)
+  {
+    assert(!_borrowed);
+
+    if (small())
+      _perm_small[x] = static_cast<uint8_t>(y);
+    else
+      _perm_large[x] = y;
+  }
+
+  void resize(unsigned degree);
+  void own();
+
   unsigned _degree;
-  std::vector<unsigned> _perm;
+  bool _borrowed = false;
+
+  // larger permutations store their images on the heap (or refer to borrowed
+  // images)
+  union
+  {
+    uint8_t _perm_small[SMALL_DEGREE];
+    unsigned *_perm_large;
+  };
 };
 
 std::ostream &operator<<(std::ostream &os, Perm const &perm);
@@ -5,6 +5,7 @@
 #include <map>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <boost/multiprecision/cpp_int.hpp>
@@ -64,9 +65,9 @@ public:
     _order(1)
   {}
 
-  explicit PermGroup(BSGS const &bsgs)
-  : _bsgs(bsgs),
-    _order(bsgs.order())
+  explicit PermGroup(BSGS bsgs)
+  : _bsgs(std::move(bsgs)),
+    _order(_bsgs.order())
   {}
 
   PermGroup(PermSet const &generators)
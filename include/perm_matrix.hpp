@@ -0,0 +1,146 @@
+#ifndef GUARD_PERM_MATRIX_H
+#define GUARD_PERM_MATRIX_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// permutations of equal degree stored row by row in a single buffer, images
+// are stored as uint8_t, uint16_t or uint32_t depending on the degree
+class PermMatrix
+{
+public:
+  explicit PermMatrix(unsigned degree = 1u, unsigned rows = 0u);
+
+  explicit PermMatrix(PermSet const &perms);
+
+  unsigned degree() const { return _degree; }
+  unsigned rows() const { return _rows; }
+  unsigned width() const { return _width; }
+
+  void resize(unsigned rows);
+
+  unsigned push_back(Perm const &perm)
+  {
+    resize(_rows + 1u);
+    set(_rows - 1u, perm);
+
+    return _rows - 1u;
+  }
+
+  unsigned image(unsigned r, unsigned x) const
+  {
+    assert(r < _rows);
+    assert(x < _degree);
+
+    switch (_width) {
+      case 1u:
+        return row<uint8_t>(r)[x];
+      case 2u:
+        return row<uint16_t>(r)[x];
+      default:
+        return row<uint32_t>(r)[x];
+    }
+  }
+
+  void set(unsigned r, Perm const &perm);
+  void set(unsigned r, unsigned const *images);
+  void set_identity(unsigned r);
+  void set_inverse(unsigned r, Perm const &perm);
+
+  Perm get(unsigned r) const
+  {
+    Perm perm(_degree);
+    get(r, perm);
+
+    return perm;
+  }
+
+  void get(unsigned r, Perm &perm) const;
+
+  bool id(unsigned r) const;
+
+  // rows[res] = rows[lhs] * rows[rhs], res may be equal to lhs but not to rhs
+  void compose(unsigned lhs, unsigned rhs, unsigned res);
+
+  // rows[res] = ~rows[r], res must not be equal to r
+  void invert(unsigned r, unsigned res);
+
+private:
+  template<typename T>
+  T *row(unsigned r)
+  { return reinterpret_cast<T *>(_data.data()) + r * _degree; }
+
+  template<typename T>
+  T const *row(unsigned r) const
+  { return reinterpret_cast<T const *>(_data.data()) + r * _degree; }
+
+  unsigned _degree;
+  unsigned _rows;
+  unsigned _width;
+
+  // padded since vectorized kernels may read a few bytes past the last row
+  std::vector<unsigned char> _data;
+};
+
+// permutations of equal degree stored point by point, i.e. the images of a
+// point under all permutations are stored contiguously, this makes it
+// possible to compare the images of a task mapping under all permutations at
+// once (tasks outside of [offset, offset + degree) are never permuted)
+class TransposedPermMatrix
+{
+public:
+  TransposedPermMatrix() = default;
+
+  explicit TransposedPermMatrix(PermSet const &perms);
+
+  unsigned degree() const { return _degree; }
+  unsigned cols() const { return _cols; }
+
+  unsigned image(unsigned c, unsigned x) const
+  {
+    assert(c < _cols);
+    assert(x < _degree);
+
+    return _images[x * _cols + c];
+  }
+
+  // index of the permutation yielding the lexicographically smallest image of
+  // tasks (the first one if there are several), cols() if no image is smaller
+  // than tasks itself, candidates is used as scratch space
+  unsigned min_image(unsigned const *tasks,
+                     unsigned num_tasks,
+                     unsigned offset,
+                     std::vector<unsigned> &candidates) const;
+
+  bool less_than(unsigned c,
+                 unsigned const *tasks,
+                 unsigned num_tasks,
+                 unsigned offset) const;
+
+  void permute(unsigned c,
+               unsigned *tasks,
+               unsigned num_tasks,
+               unsigned offset) const;
+
+private:
+  unsigned _degree = 0u;
+  unsigned _cols = 0u;
+
+  std::vector<uint32_t> _images;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_PERM_MATRIX_H
@@ -7,6 +7,7 @@
 #include <ostream>
 #include <sstream>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "dump.hpp"
@@ -93,7 +94,7 @@ public:
   void insert(Perm &&perm)
   {
     assert_degree(perm.degree());
-    _perms.emplace_back(perm); // TODO: forward
+    _perms.emplace_back(std::move(perm));
   }
 
   template<typename IT>
@@ -1,6 +1,8 @@
 #ifndef GUARD_PR_RANDOMIZER_H
 #define GUARD_PR_RANDOMIZER_H
 
+#include <random>
+
 #include "perm_set.hpp"
 
 namespace mpsym
@@ -11,6 +13,9 @@ namespace internal
 
 class Perm;
 
+// product replacement random group element generator, every randomizer owns
+// its random engine, i.e. several randomizers can safely be used concurrently
+// and seeding them makes their sequences of elements reproducible
 class PrRandomizer
 {
 public:
@@ -18,6 +23,11 @@ public:
                unsigned n_generators = 10,
                unsigned iterations = 20);
 
+  PrRandomizer(PermSet const &generators,
+               std::mt19937 const &re,
+               unsigned n_generators = 10,
+               unsigned iterations = 20);
+
   Perm next();
 
   bool test_symmetric(double epsilon = 1e-6);
@@ -28,6 +38,8 @@ private:
 
   PermSet _gens_orig;
   PermSet _gens;
+
+  std::mt19937 _re;
 };
 
 } // namespace internal
@@ -3,9 +3,12 @@
 
 #include <cassert>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include "perm.hpp"
+#include "perm_matrix.hpp"
+#include "perm_set.hpp"
 #include "schreier_structure.hpp"
 #include "util.hpp"
 
@@ -60,8 +63,17 @@ public:
     bool _end;
   };
 
+  // position of the current schreier generator, see state() and restore()
+  struct State
+  {
+    sg_it_type sg_it;
+    fo_it_type beta_it;
+  };
+
   SchreierGeneratorQueue()
-  : _valid(false)
+  : _valid(false),
+    _used(false),
+    _exhausted(true)
   {}
 
   void update(sg_type const &strong_generators,
@@ -80,7 +92,21 @@ public:
 
     _schreier_structure = schreier_structure;
 
-    _u_beta = u_beta();
+    // strong generators followed by u_beta, ~u_beta_x and the result
+    Perm u_beta_first(u_beta());
+
+    _work = PermMatrix(u_beta_first.degree(), strong_generators.size() + 3u);
+
+    for (unsigned i = 0u; i < strong_generators.size(); ++i)
+      _work.set(i, strong_generators[i]);
+
+    _u_beta_row = strong_generators.size();
+    _u_beta_x_inv_row = _u_beta_row + 1u;
+    _schreier_generator_row = _u_beta_row + 2u;
+
+    _work.set(_u_beta_row, u_beta_first);
+
+    _images.resize(u_beta_first.degree());
 
     _valid = true;
     _used = false;
@@ -89,6 +115,24 @@ public:
 
   void invalidate() { _valid = false; }
 
+  State state() const
+  { return {_sg_it, _beta_it}; }
+
+  // rewind the queue such that the generator current when state was obtained
+  // is considered used and iteration resumes directly after it
+  void restore(State const &state)
+  {
+    _sg_it = state.sg_it;
+
+    if (_beta_it != state.beta_it) {
+      _beta_it = state.beta_it;
+      _work.set(_u_beta_row, u_beta());
+    }
+
+    _used = true;
+    _exhausted = false;
+  }
+
   const_iterator begin() { return const_iterator(this); }
   const_iterator end() { return const_iterator(); }
 
@@ -96,8 +140,8 @@ private:
   Perm u_beta()
   { return _schreier_structure->transversal(*_beta_it); }
 
-  Perm u_beta_x()
-  { return _schreier_structure->transversal((*_sg_it)[*_beta_it]); }
+  unsigned sg_row() const
+  { return static_cast<unsigned>(_sg_it - _sg_begin); }
 
   void next_sg()
   {
@@ -111,7 +155,7 @@ private:
       _exhausted = true;
     } else {
       _sg_it = _sg_begin;
-      _u_beta = u_beta();
+      _work.set(_u_beta_row, u_beta());
     }
   }
 
@@ -120,13 +164,29 @@ private:
     if (_used)
       next_sg();
 
-    while (!_exhausted && _schreier_structure->incoming(*_beta_it, *_sg_it))
-      next_sg();
+    for (; !_exhausted; next_sg()) {
+      if (_schreier_structure->incoming(*_beta_it, *_sg_it))
+        continue;
 
-    if (_exhausted)
-      return;
+      // ~u_beta_x is obtained by applying it to the identity, u_beta_x
+      // itself is never constructed
+      std::iota(_images.begin(), _images.end(), 0u);
 
-    _schreier_generator = _u_beta * (*_sg_it) * ~u_beta_x();
+      _schreier_structure->transversal_apply_inverse(
+        (*_sg_it)[*_beta_it], _images.data(), _images.data() + _images.size());
+
+      _work.set(_u_beta_x_inv_row, _images.data());
+      _work.compose(_u_beta_row, sg_row(), _schreier_generator_row);
+      _work.compose(_schreier_generator_row,
+                    _u_beta_x_inv_row,
+                    _schreier_generator_row);
+
+      // trivial schreier generators are skipped without leaving the matrix
+      if (!_work.id(_schreier_generator_row)) {
+        _work.get(_schreier_generator_row, _schreier_generator);
+        return;
+      }
+    }
   }
 
   void mark_used() { _used = true; }
@@ -144,7 +204,13 @@ private:
   bool _used;
   bool _exhausted;
 
-  Perm _u_beta;
+  PermMatrix _work;
+  unsigned _u_beta_row;
+  unsigned _u_beta_x_inv_row;
+  unsigned _schreier_generator_row;
+
+  std::vector<unsigned> _images;
+
   Perm _schreier_generator;
 };
 
@@ -34,6 +34,13 @@ struct SchreierStructure
   virtual bool incoming(unsigned node, Perm const &edge) const = 0;
   virtual Perm transversal(unsigned origin) const = 0;
 
+  // replaces every x in [first, last) by its preimage under
+  // transversal(origin), implementations that can avoid constructing the
+  // transversal should override this
+  virtual void transversal_apply_inverse(unsigned origin,
+                                         unsigned *first,
+                                         unsigned *last) const;
+
 private:
   virtual void dump(std::ostream& os) const = 0;
 };
@@ -1,7 +1,7 @@
 #ifndef GUARD_SCHREIER_TREE_H
 #define GUARD_SCHREIER_TREE_H
 
-#include <map>
+#include <cstdint>
 #include <ostream>
 #include <vector>
 
@@ -15,18 +15,18 @@ namespace mpsym
 namespace internal
 {
 
+// schreier tree stored in flat arrays indexed by node, next to the labels
+// their inverses are kept in one contiguous buffer such that inverted
+// transversals can be applied by simply walking up the tree
 struct SchreierTree : public SchreierStructure
 {
-  SchreierTree(unsigned degree, unsigned root, PermSet const &labels)
-  : _degree(degree),
-    _root(root),
-    _labels(labels)
-  {}
+  static constexpr uint32_t NO_EDGE = UINT32_MAX;
+
+  SchreierTree(unsigned degree, unsigned root, PermSet const &labels);
 
   virtual ~SchreierTree() = default;
 
-  void add_label(Perm const &label) override
-  { _labels.insert(label); }
+  void add_label(Perm const &label) override;
 
   void create_edge(unsigned origin,
                    unsigned destination,
@@ -40,14 +40,29 @@ struct SchreierTree : public SchreierStructure
   bool incoming(unsigned node, Perm const &edge) const override;
   Perm transversal(unsigned origin) const override;
 
+  void transversal_apply_inverse(unsigned origin,
+                                 unsigned *first,
+                                 unsigned *last) const override;
+
+  // number of labels on the path from origin to the root
+  unsigned word_length(unsigned origin) const
+  { return _word_lengths[origin]; }
+
 private:
   void dump(std::ostream &os) const override;
 
+  unsigned const *inverse_label(unsigned i) const
+  { return _inverse_labels.data() + i * _degree; }
+
   unsigned _degree;
   unsigned _root;
-  std::map<unsigned, unsigned> _edges;
+
+  std::vector<uint32_t> _edges;
+  std::vector<uint32_t> _edge_labels;
+  std::vector<unsigned> _word_lengths;
+
   PermSet _labels;
-  std::map<unsigned, unsigned> _edge_labels;
+  std::vector<unsigned> _inverse_labels;
 };
 
 } // namespace internal
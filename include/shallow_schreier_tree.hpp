@@ -0,0 +1,94 @@
+#ifndef GUARD_SHALLOW_SCHREIER_TREE_H
+#define GUARD_SHALLOW_SCHREIER_TREE_H
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "schreier_structure.hpp"
+#include "schreier_tree.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// schreier tree of logarithmic depth, the orbit is first enumerated with a
+// regular schreier tree from which a set of "cube" generators is then derived
+// (see Seress, "Permutation Group Algorithms", Section 4.4), the shallow tree
+// spanned by these is (re)built lazily once a transversal is requested
+struct ShallowSchreierTree : public SchreierStructure
+{
+  ShallowSchreierTree(unsigned degree, unsigned root, PermSet const &labels)
+  : _degree(degree),
+    _root(root),
+    _tree(degree, root, labels),
+    _valid(false)
+  {}
+
+  virtual ~ShallowSchreierTree() = default;
+
+  void add_label(Perm const &label) override
+  {
+    _tree.add_label(label);
+    _valid = false;
+  }
+
+  void create_edge(unsigned origin,
+                   unsigned destination,
+                   unsigned label) override
+  {
+    _tree.create_edge(origin, destination, label);
+    _valid = false;
+  }
+
+  unsigned root() const override
+  { return _root; }
+
+  std::vector<unsigned> nodes() const override
+  { return _tree.nodes(); }
+
+  PermSet labels() const override
+  { return _tree.labels(); }
+
+  bool contains(unsigned node) const override
+  { return _tree.contains(node); }
+
+  bool incoming(unsigned node, Perm const &edge) const override;
+  Perm transversal(unsigned origin) const override;
+
+  void transversal_apply_inverse(unsigned origin,
+                                 unsigned *first,
+                                 unsigned *last) const override;
+
+  unsigned depth() const;
+
+private:
+  void dump(std::ostream &os) const override;
+
+  void update() const;
+  std::vector<bool> cube_orbit(std::vector<Perm> const &cube) const;
+
+  unsigned _degree;
+  unsigned _root;
+
+  SchreierTree _tree;
+
+  mutable std::atomic<bool> _valid;
+  mutable std::mutex _update_mtx;
+
+  mutable std::vector<Perm> _cube_labels;
+  mutable std::vector<unsigned> _edges;
+  mutable std::vector<int> _edge_labels;
+  mutable unsigned _depth;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_SHALLOW_SCHREIER_TREE_H
@@ -30,7 +30,7 @@ public:
   : std::vector<unsigned>(tasks)
   {}
 
-  bool less_than(TaskMapping const other) const
+  bool less_than(TaskMapping const &other) const
   {
     assert(size() == other.size());
 
@@ -48,7 +48,7 @@ public:
   }
 
   template<typename PERM>
-  bool less_than(TaskMapping const other,
+  bool less_than(TaskMapping const &other,
                  PERM const &perm,
                  unsigned offset = 0u) const
   {
@@ -0,0 +1,79 @@
+#ifndef GUARD_TASK_MAPPING_FILE_H
+#define GUARD_TASK_MAPPING_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+// read only view of a (memory mapped) binary task mapping file, tasks are
+// stored as fixed width 8, 16 or 32-bit unsigned integers depending on the
+// number of processors and only decoded on access, see save for the file
+// format, views are cheap to copy and keep the mapping alive
+class TaskMappingView
+{
+public:
+  TaskMappingView() = default;
+  explicit TaskMappingView(std::string const &file);
+
+  // true if file starts like a binary task mapping file
+  static bool is_task_mapping_file(std::string const &file);
+
+  // num_processors is determined from the mappings if it is zero
+  static void save(std::string const &file,
+                   TaskMapping const *mappings,
+                   std::size_t num_mappings,
+                   unsigned num_processors = 0u);
+
+  // as above but mappings are stored row by row in a flat buffer
+  static void save_flat(std::string const &file,
+                        unsigned const *mappings,
+                        std::size_t num_mappings,
+                        std::size_t mapping_size,
+                        unsigned num_processors = 0u);
+
+  std::size_t size() const
+  { return _num_mappings; }
+
+  bool empty() const
+  { return _num_mappings == 0u; }
+
+  unsigned num_tasks() const
+  { return _num_tasks; }
+
+  unsigned num_processors() const
+  { return _num_processors; }
+
+  unsigned task_bytes() const
+  { return _task_bytes; }
+
+  unsigned task(std::size_t i, unsigned j) const;
+
+  TaskMapping operator[](std::size_t i) const;
+
+  void copy(std::size_t i, unsigned *tasks) const;
+
+  // view of the mappings first, ..., first + num_mappings - 1
+  TaskMappingView slice(std::size_t first, std::size_t num_mappings) const;
+
+private:
+  unsigned char const *row(std::size_t i) const
+  { return _rows + i * _num_tasks * _task_bytes; }
+
+  std::shared_ptr<void const> _data;
+  unsigned char const *_rows = nullptr;
+
+  std::size_t _num_mappings = 0u;
+  unsigned _num_tasks = 0u;
+  unsigned _num_processors = 0u;
+  unsigned _task_bytes = 0u;
+};
+
+} // namespace mpsym
+
+#endif // GUARD_TASK_MAPPING_FILE_H
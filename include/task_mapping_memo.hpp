@@ -0,0 +1,110 @@
+#ifndef GUARD_TASK_MAPPING_MEMO_H
+#define GUARD_TASK_MAPPING_MEMO_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// bounded map from task mappings to their orbit representatives and orbit
+// indices, split into (at most num_shards) shards of at least
+// MIN_SHARD_CAPACITY entries which are each protected by their own mutex,
+// full shards evict entries following the CLOCK policy, i.e. the clock hand
+// sweeps over all entries of a shard, skipping (and unmarking) entries which
+// have been looked up since it last passed them, entries are additionally
+// keyed by a tag which identifies the options used to determine them
+class TaskMappingMemo
+{
+public:
+  static constexpr unsigned DEFAULT_NUM_SHARDS = 64u;
+  static constexpr std::size_t MIN_SHARD_CAPACITY = 256u;
+
+  struct Stats
+  {
+    uint64_t hits = 0u;
+    uint64_t misses = 0u;
+    uint64_t evictions = 0u;
+  };
+
+  explicit TaskMappingMemo(std::size_t capacity,
+                           unsigned num_shards = DEFAULT_NUM_SHARDS);
+
+  std::size_t capacity() const
+  { return _capacity; }
+
+  std::size_t size() const;
+
+  bool lookup(TaskMapping const &mapping,
+              uint64_t tag,
+              TaskMapping &representative,
+              unsigned &orbit_index);
+
+  void insert(TaskMapping const &mapping,
+              uint64_t tag,
+              TaskMapping const &representative,
+              unsigned orbit_index);
+
+  Stats stats() const;
+
+private:
+  struct Key
+  {
+    TaskMapping mapping;
+    uint64_t tag;
+
+    bool operator==(Key const &rhs) const
+    { return tag == rhs.tag && mapping == rhs.mapping; }
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(Key const &key) const
+    { return std::hash<TaskMapping>()(key.mapping) ^ std::hash<uint64_t>()(key.tag); }
+  };
+
+  struct Entry
+  {
+    Key key;
+    TaskMapping representative;
+    unsigned orbit_index;
+    bool referenced;
+  };
+
+  struct Shard
+  {
+    std::size_t capacity = 0u;
+
+    std::vector<Entry> entries;
+    std::unordered_map<Key, std::size_t, KeyHash> index;
+    std::size_t hand = 0u;
+
+    mutable std::mutex mtx;
+  };
+
+  Shard &shard(TaskMapping const &mapping) const;
+
+  std::size_t _capacity;
+  std::vector<std::unique_ptr<Shard>> _shards;
+
+  std::atomic<uint64_t> _hits;
+  std::atomic<uint64_t> _misses;
+  std::atomic<uint64_t> _evictions;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_TASK_MAPPING_MEMO_H
@@ -3,15 +3,19 @@
 
 #include <algorithm>
 #include <cassert>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
+#include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "perm_set.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_memo.hpp"
+#include "task_mapping_orbit_enumerator.hpp"
+#include "task_mapping_store.hpp"
 #include "util.hpp"
 
 namespace mpsym
@@ -21,18 +25,14 @@ class TMO
 {
   class IterationState
   {
-    using hash_type = uint32_t;
-
   public:
     IterationState(TMO const *orbit)
     : _singular(orbit->_generators.empty()),
       _generators(&orbit->_generators),
+      _ranking(orbit->_root, orbit->_generators),
       _unprocessed{orbit->_root}
     {
       current = _unprocessed.begin();
-
-      if (!_singular)
-        init_hash(orbit->_root);
     }
 
     std::unordered_set<TaskMapping>::iterator current;
@@ -41,18 +41,22 @@ class TMO
     bool exhausted() const;
 
   private:
-    void init_hash(TaskMapping const &root);
-    hash_type perfect_hash(TaskMapping const &mapping) const;
-    static hash_type container_hash_truncated(TaskMapping const &mapping);
+    bool processed(TaskMapping const &mapping) const;
+    void mark_processed(TaskMapping const &mapping);
 
     bool _singular;
     internal::PermSet const *_generators;
 
-    std::function<hash_type(TaskMapping)> _hash;
-    std::unordered_map<unsigned, unsigned> _hash_support_map;
+    // processed mappings are stored as (exact) ranks unless these do not fit
+    // into two words
+    internal::TaskMappingRanking _ranking;
+
+    std::unordered_set<internal::TaskMappingRanking::rank_type,
+                       internal::TaskMappingRanking::RankHash> _processed_ranks;
+
+    std::unordered_set<TaskMapping> _processed_mappings;
 
     std::unordered_set<TaskMapping> _unprocessed;
-    std::unordered_set<hash_type> _processed;
   };
 
 public:
@@ -102,6 +106,14 @@ public:
   const_iterator end() const
   { return const_iterator(); }
 
+  // size of the orbit and all its mappings in breadth first order, determined
+  // by num_threads threads, see internal::TMOEnumerator
+  uint64_t size(unsigned num_threads = 0u) const
+  { return internal::TMOEnumerator(_root, _generators, num_threads).size(); }
+
+  std::vector<TaskMapping> mappings(unsigned num_threads = 0u) const
+  { return internal::TMOEnumerator(_root, _generators, num_threads).mappings(); }
+
 private:
   TaskMapping _root;
   internal::PermSet _generators;
@@ -109,37 +121,95 @@ private:
 
 class TMORs
 {
-  using orbit_reprs_map = std::unordered_map<TaskMapping, unsigned>;
-
 public:
   class const_iterator
-  : public util::Iterator<const_iterator, TaskMapping const>
+  : public util::Iterator<const_iterator, TaskMapping const, true>
   {
   public:
-    const_iterator(orbit_reprs_map::const_iterator const &it)
-    : _it(it)
-    {}
+    const_iterator(internal::TaskMappingStore const *store,
+                   unsigned shard,
+                   unsigned row = 0u)
+    : _store(store),
+      _shard(shard),
+      _row(row)
+    { skip_empty_shards(); }
 
     bool operator==(const_iterator const &rhs) const override
-    { return _it == rhs._it; }
+    { return _shard == rhs._shard && _row == rhs._row; }
 
   private:
-    reference current() override
-    { return _it->first; }
+    TaskMapping current() override
+    {
+      unsigned const *tasks = _store->row(_shard, _row);
+
+      return TaskMapping(std::vector<unsigned>(tasks, tasks + _store->width()));
+    }
 
     void next() override
-    { ++_it; }
+    {
+      ++_row;
+      skip_empty_shards();
+    }
+
+    void skip_empty_shards()
+    {
+      while (_shard < _store->num_shards() && _row == _store->num_rows(_shard)) {
+        ++_shard;
+        _row = 0u;
+      }
+    }
 
-    orbit_reprs_map::const_iterator _it;
+    internal::TaskMappingStore const *_store;
+    unsigned _shard;
+    unsigned _row;
   };
 
+  TMORs() = default;
+
+  // representatives are stored in memory mapped files in spill_directory
+  // instead of on the heap, see internal::TaskMappingStore
+  explicit TMORs(std::string const &spill_directory)
+  : _orbit_reprs(spill_directory)
+  {}
+
+  // copies start out with an empty memo of the same capacity
+  TMORs(TMORs const &other)
+  : _orbit_reprs(other._orbit_reprs)
+  { set_memo_capacity(other.memo_capacity()); }
+
+  TMORs &operator=(TMORs const &other)
+  {
+    _orbit_reprs = other._orbit_reprs;
+    set_memo_capacity(other.memo_capacity());
+
+    return *this;
+  }
+
+  // moves keep the memo
+  TMORs(TMORs &&) = default;
+  TMORs &operator=(TMORs &&) = default;
+
   bool operator==(TMORs const &rhs) const
-  { return orbit_repr_set() == rhs.orbit_repr_set(); }
+  {
+    if (num_orbits() != rhs.num_orbits())
+      return false;
+
+    for (auto const &repr : *this) {
+      if (!rhs.is_repr(repr))
+        return false;
+    }
+
+    return true;
+  }
 
   bool operator!=(TMORs const &rhs) const
   { return !(*this == rhs); }
 
-  std::pair<bool, unsigned> insert(TaskMapping const &mapping);
+  std::pair<bool, unsigned> insert(TaskMapping const &mapping)
+  {
+    return _orbit_reprs.insert(mapping.data(),
+                               static_cast<unsigned>(mapping.size()));
+  }
 
   template<typename IT>
   void insert_all(IT first, IT last)
@@ -150,31 +220,47 @@ public:
 
   bool is_repr(TaskMapping const &mapping) const
   {
-    auto it(_orbit_reprs.find(mapping));
-
-    return it != _orbit_reprs.end();
+    return _orbit_reprs.contains(mapping.data(),
+                                 static_cast<unsigned>(mapping.size()));
   }
 
   unsigned num_orbits() const
-  { return static_cast<unsigned>(_orbit_reprs.size()); }
+  { return _orbit_reprs.size(); }
 
   const_iterator begin() const
-  { return const_iterator(_orbit_reprs.begin()); }
+  { return const_iterator(&_orbit_reprs, 0u); }
 
   const_iterator end() const
-  { return const_iterator(_orbit_reprs.end()); }
-
-private:
-  std::unordered_set<TaskMapping> orbit_repr_set() const
+  { return const_iterator(&_orbit_reprs, _orbit_reprs.num_shards()); }
+
+  // if capacity is non-zero, ArchGraphSystem::repr remembers the
+  // representatives and orbit indices of up to capacity (not necessarily
+  // canonical) mappings and skips the search for mappings it has already
+  // seen (with the same offset and search method), this assumes that all
+  // representatives inserted into this object are determined by the same
+  // system, resets the memo
+  void set_memo_capacity(std::size_t capacity)
   {
-    std::unordered_set<TaskMapping> ret;
-    for (auto const &repr : _orbit_reprs)
-      ret.insert(repr.first);
-
-    return ret;
+    if (capacity == 0u)
+      _memo.reset();
+    else
+      _memo.reset(new internal::TaskMappingMemo(capacity));
   }
 
-  orbit_reprs_map _orbit_reprs;
+  std::size_t memo_capacity() const
+  { return _memo ? _memo->capacity() : 0u; }
+
+  internal::TaskMappingMemo *memo() const
+  { return _memo.get(); }
+
+  internal::TaskMappingMemo::Stats memo_stats() const
+  { return _memo ? _memo->stats() : internal::TaskMappingMemo::Stats(); }
+
+private:
+  // allows insertion from several threads, see ArchGraphSystem::repr_batch
+  internal::TaskMappingStore _orbit_reprs;
+
+  std::unique_ptr<internal::TaskMappingMemo> _memo;
 };
 
 } // namespace mpsym
@@ -0,0 +1,92 @@
+#ifndef GUARD_TASK_MAPPING_ORBIT_ENUMERATOR_H
+#define GUARD_TASK_MAPPING_ORBIT_ENUMERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// exact ranks of all task mappings in the orbit of root, the tasks of a
+// mapping are interpreted as the digits of a mixed radix number over the
+// support of the generators (and the tasks of root), ranks are packed into
+// one 64-bit word if possible and into two otherwise
+class TaskMappingRanking
+{
+public:
+  using rank_type = std::pair<uint64_t, uint64_t>;
+
+  struct RankHash
+  {
+    std::size_t operator()(rank_type const &rank) const
+    { return static_cast<std::size_t>(rank.first * 0x9e3779b97f4a7c15ULL ^ rank.second); }
+  };
+
+  TaskMappingRanking(TaskMapping const &root, PermSet const &generators);
+
+  // number of words per rank, zero if ranks do not fit into two words
+  unsigned words() const { return _words; }
+
+  // number of distinct ranks, only meaningful if words() == 1
+  uint64_t num_ranks() const { return _num_ranks; }
+
+  unsigned num_digits() const { return _num_digits; }
+  unsigned num_digits_low() const { return _num_digits_low; }
+  unsigned radix() const { return static_cast<unsigned>(_tasks.size()); }
+
+  unsigned digit(unsigned task) const { return _digits[task]; }
+  unsigned task(unsigned digit) const { return _tasks[digit]; }
+
+  rank_type rank(TaskMapping const &mapping) const;
+  TaskMapping unrank(rank_type const &rank) const;
+
+private:
+  unsigned _words;
+  uint64_t _num_ranks;
+
+  unsigned _num_digits;
+  unsigned _num_digits_low;
+
+  std::vector<unsigned> _tasks;
+  std::vector<unsigned> _digits;
+};
+
+// breadth first enumeration of task mapping orbits, frontiers are expanded in
+// parallel and visited mappings are recorded exactly in a concurrent bitmap
+// (if there are at most max_bitmap_bits possible ranks), a lock-free hash
+// table of 64-bit ranks or, as a last resort, a sharded hash set
+class TMOEnumerator
+{
+public:
+  static constexpr uint64_t DEFAULT_MAX_BITMAP_BITS = 1ULL << 30;
+
+  TMOEnumerator(TaskMapping const &root,
+                PermSet const &generators,
+                unsigned num_threads = 0u,
+                uint64_t max_bitmap_bits = DEFAULT_MAX_BITMAP_BITS);
+
+  uint64_t size() const;
+  std::vector<TaskMapping> mappings() const;
+
+private:
+  uint64_t enumerate(std::vector<TaskMapping> *mappings) const;
+
+  TaskMapping _root;
+  PermSet _generators;
+  unsigned _num_threads;
+  uint64_t _max_bitmap_bits;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_TASK_MAPPING_ORBIT_ENUMERATOR_H
@@ -0,0 +1,109 @@
+#ifndef GUARD_TASK_MAPPING_STORE_H
+#define GUARD_TASK_MAPPING_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// set of equally long task mappings, each associated with a consecutive
+// index, mappings are packed into fixed width rows (the tasks followed by
+// their index) which are stored in one arena per shard, every shard is
+// indexed by an open addressing hash table of row numbers and protected by
+// its own mutex such that insertions and lookups from several threads only
+// contend if they fall into the same shard, if a spill directory is given,
+// arenas are memory mapped from regions of one (unlinked) file in that
+// directory instead of residing on the heap
+class TaskMappingStore
+{
+public:
+  static constexpr unsigned DEFAULT_NUM_SHARDS = 64u;
+
+  explicit TaskMappingStore(std::string const &spill_directory = "",
+                            unsigned num_shards = DEFAULT_NUM_SHARDS);
+
+  TaskMappingStore(TaskMappingStore const &other);
+  TaskMappingStore &operator=(TaskMappingStore const &other);
+
+  // moved from stores must be assigned to before they are used again
+  TaskMappingStore(TaskMappingStore &&other);
+  TaskMappingStore &operator=(TaskMappingStore &&other);
+
+  ~TaskMappingStore();
+
+  std::pair<bool, unsigned> insert(unsigned const *tasks, unsigned num_tasks);
+  bool contains(unsigned const *tasks, unsigned num_tasks) const;
+
+  unsigned size() const
+  { return _size.load(); }
+
+  // number of tasks per mapping, only meaningful if size() > 0
+  unsigned width() const
+  { return _width.load(); }
+
+  std::string const &spill_directory() const
+  { return _spill_directory; }
+
+  // not thread safe, rows may move during concurrent insertions
+  unsigned num_shards() const
+  { return static_cast<unsigned>(_shards.size()); }
+
+  unsigned num_rows(unsigned shard) const;
+  unsigned const *row(unsigned shard, unsigned i) const;
+
+private:
+  static constexpr unsigned NO_WIDTH = std::numeric_limits<unsigned>::max();
+
+  class Arena;
+  class SpillFile;
+
+  struct Shard
+  {
+    std::unique_ptr<Arena> rows;
+    unsigned num_rows = 0u;
+
+    // row numbers plus one, zero marks empty slots
+    std::vector<uint32_t> index;
+
+    mutable std::mutex mtx;
+  };
+
+  uint64_t hash(unsigned const *tasks, unsigned num_tasks) const;
+  Shard &shard(uint64_t hash) const;
+
+  // index slot containing the given mapping or the empty slot at which it
+  // would be inserted, false in the latter case
+  bool find(Shard const &shard,
+            uint64_t hash,
+            unsigned const *tasks,
+            unsigned num_tasks,
+            std::size_t &slot) const;
+
+  void grow_index(Shard &shard) const;
+
+  unsigned const *row(Shard const &shard, unsigned i) const;
+
+  std::string _spill_directory;
+  std::shared_ptr<SpillFile> _spill_file;
+  std::vector<std::unique_ptr<Shard>> _shards;
+
+  std::atomic<unsigned> _width;
+  std::atomic<unsigned> _size;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_TASK_MAPPING_STORE_H
@@ -0,0 +1,110 @@
+#ifndef GUARD_THREAD_POOL_H
+#define GUARD_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+class ThreadPool
+{
+public:
+  using task_type = std::function<void(std::size_t)>;
+
+  explicit ThreadPool(unsigned num_threads = 0u);
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const &) = delete;
+  ThreadPool &operator=(ThreadPool const &) = delete;
+
+  static unsigned default_num_threads();
+
+  unsigned num_threads() const
+  { return static_cast<unsigned>(_workers.size()) + 1u; }
+
+  // runs task(0), ..., task(n - 1) on at most max_threads threads (including
+  // the calling thread), zero means all threads of the pool
+  void parallel_for(std::size_t n,
+                    task_type const &task,
+                    unsigned max_threads = 0u);
+
+private:
+  void work(unsigned index);
+  void run_task();
+
+  std::vector<std::thread> _workers;
+
+  std::mutex _mtx;
+  std::condition_variable _cv_task;
+  std::condition_variable _cv_done;
+
+  task_type const *_task = nullptr;
+  std::size_t _task_size = 0u;
+  std::atomic<std::size_t> _task_next;
+  unsigned _task_num_workers = 0u;
+  unsigned _task_pending = 0u;
+  unsigned long _task_generation = 0u;
+  std::exception_ptr _task_exception;
+
+  bool _stop = false;
+};
+
+// thread pool shared by several callers (e.g. all multi start local
+// searches), the pool is created on first use and only ever grows so that
+// callers requesting different numbers of threads do not recreate it,
+// callers which find it leased (by another thread or further up the stack)
+// obtain an empty lease
+class SharedThreadPool
+{
+public:
+  class Lease
+  {
+    friend class SharedThreadPool;
+
+  public:
+    explicit operator bool() const
+    { return _pool != nullptr; }
+
+    // runs task on the leased number of threads or sequentially on the
+    // calling thread if the lease is empty
+    void parallel_for(std::size_t n, ThreadPool::task_type const &task) const;
+
+  private:
+    Lease(std::unique_lock<std::mutex> lock,
+          ThreadPool *pool,
+          unsigned num_threads)
+    : _lock(std::move(lock)),
+      _pool(pool),
+      _num_threads(num_threads)
+    {}
+
+    std::unique_lock<std::mutex> _lock;
+    ThreadPool *_pool;
+    unsigned _num_threads;
+  };
+
+  // zero means ThreadPool::default_num_threads()
+  Lease lease(unsigned num_threads = 0u);
+
+private:
+  std::mutex _mtx;
+  std::unique_ptr<ThreadPool> _pool;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_THREAD_POOL_H
@@ -6,6 +6,7 @@
 #include <condition_variable>
 #include <functional>
 #include <future>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -117,10 +118,11 @@ run_with_timeout(std::string const &what,
                  std::chrono::duration<REP, PERIOD> const &timeout,
                  FUNC &&f)
 {
+  // f is copied since it might keep running after this function has returned
   (void)future_with_timeout(
     what,
     timeout,
-    [&]() {
+    [f]() mutable {
        try {
          f();
        } catch (AbortedError const &aborted) {}
@@ -136,10 +138,11 @@ run_with_timeout(std::string const &what,
                  std::chrono::duration<REP, PERIOD> const &timeout,
                  FUNC &&f)
 {
+  // f is copied since it might keep running after this function has returned
   auto future(future_with_timeout(
     what,
     timeout,
-    [&]() {
+    [f]() mutable {
       ReturnTypeWrapper<FUNC> ret;
 
       try {
@@ -154,6 +157,42 @@ run_with_timeout(std::string const &what,
   return *future.get();
 }
 
+// single persistent thread that sets abort flags once their deadlines have
+// passed, arming and disarming a deadline is cheap
+class Watchdog
+{
+public:
+  using clock = std::chrono::steady_clock;
+  using deadline_type = std::pair<clock::time_point, unsigned long>;
+
+  static Watchdog &instance();
+
+  ~Watchdog();
+
+  Watchdog(Watchdog const &) = delete;
+  Watchdog &operator=(Watchdog const &) = delete;
+
+  deadline_type arm(clock::time_point deadline, flag const &f);
+  void disarm(deadline_type const &deadline);
+
+private:
+  Watchdog() = default;
+
+  void watch();
+
+  std::map<deadline_type, flag> _deadlines;
+  unsigned long _next_id = 0ul;
+
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  std::thread _thread;
+  bool _stop = false;
+};
+
+// f is executed on the calling thread and must regularly check its abort flag
+// (and throw AbortedError once it is set), unlike run_with_timeout no threads
+// are created and timed out functions do not keep running in the background,
+// functions that cannot be interrupted must use the threaded variant below
 template<typename FUNC, typename REP, typename PERIOD>
 AbortableReturnType<FUNC>
 run_abortable_with_timeout(std::string const &what,
@@ -162,13 +201,55 @@ run_abortable_with_timeout(std::string const &what,
 {
   flag aborted(unset());
 
+  if (timeout <= std::chrono::duration<double>::zero())
+    return f(aborted);
+
+  auto &watchdog(Watchdog::instance());
+
+  struct Disarm
+  {
+    ~Disarm()
+    { watchdog.disarm(deadline); }
+
+    Watchdog &watchdog;
+    Watchdog::deadline_type deadline;
+  } disarm {
+    watchdog,
+    watchdog.arm(Watchdog::clock::now() +
+                   std::chrono::duration_cast<Watchdog::clock::duration>(timeout),
+                 aborted)
+  };
+
+  try {
+    return f(aborted);
+
+  } catch (AbortedError const &) {
+    if (is_set(aborted))
+      throw TimeoutError(what);
+
+    throw;
+  }
+}
+
+// fallback for functions which do not (or not always) check their abort flag,
+// f is executed on a separate thread (see run_with_timeout) and its abort flag
+// is set once it times out
+template<typename FUNC, typename REP, typename PERIOD>
+AbortableReturnType<FUNC>
+run_abortable_with_timeout_threaded(
+  std::string const &what,
+  std::chrono::duration<REP, PERIOD> const &timeout,
+  FUNC &&f)
+{
+  flag aborted(unset());
+
   if (timeout <= std::chrono::duration<double>::zero())
     return f(aborted);
 
   try {
     return run_with_timeout(what,
                             timeout,
-                            [&]{ return f(aborted); });
+                            [f, aborted]() mutable { return f(aborted); });
 
   } catch (TimeoutError const &) {
     set(aborted);
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arch_graph_system.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
+#include "task_mapping_orbit.hpp"
+
+#include "profile_stream.hpp"
+#include "profile_util.hpp"
+
+namespace
+{
+
+using stream_clock = std::chrono::steady_clock;
+
+double seconds_since(stream_clock::time_point start)
+{ return std::chrono::duration<double>(stream_clock::now() - start).count(); }
+
+// read only memory mapping of a whole file
+class MappedFile
+{
+public:
+  MappedFile(std::string const &file)
+  {
+    _fd = open(file.c_str(), O_RDONLY);
+    if (_fd == -1)
+      throw std::runtime_error("failed to open file");
+
+    struct stat st;
+    if (fstat(_fd, &st) == -1) {
+      close(_fd);
+      throw std::runtime_error("failed to stat file");
+    }
+
+    _size = static_cast<std::size_t>(st.st_size);
+
+    if (_size == 0u)
+      return;
+
+    void *addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (addr == MAP_FAILED) {
+      close(_fd);
+      throw std::runtime_error("failed to map file");
+    }
+
+    _data = static_cast<char const *>(addr);
+
+    madvise(addr, _size, MADV_SEQUENTIAL);
+  }
+
+  ~MappedFile()
+  {
+    if (_data)
+      munmap(const_cast<char *>(_data), _size);
+
+    close(_fd);
+  }
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  char const *data() const
+  { return _data; }
+
+  std::size_t size() const
+  { return _size; }
+
+  // drop the pages fully contained in [first, last) from the resident set
+  void release(char const *first, char const *last) const
+  {
+    static std::size_t const page_size = sysconf(_SC_PAGESIZE);
+
+    std::size_t offs_first = first - _data;
+    std::size_t offs_last = last - _data;
+
+    offs_first = (offs_first + page_size - 1u) / page_size * page_size;
+    offs_last = offs_last / page_size * page_size;
+
+    if (offs_first < offs_last) {
+      madvise(const_cast<char *>(_data) + offs_first,
+              offs_last - offs_first,
+              MADV_DONTNEED);
+    }
+  }
+
+private:
+  int _fd = -1;
+  char const *_data = nullptr;
+  std::size_t _size = 0u;
+};
+
+struct Chunk
+{
+  char const *first;
+  char const *last;
+};
+
+using Batch = std::vector<mpsym::TaskMapping>;
+
+bool parse_task_mapping(char const *&it,
+                        char const *last,
+                        mpsym::TaskMapping &task_mapping)
+{
+  task_mapping.clear();
+
+  bool in_number = false;
+  unsigned pe = 0u;
+
+  for (; it != last && *it != '\n'; ++it) {
+    char c = *it;
+
+    if (c >= '0' && c <= '9') {
+      pe = 10u * pe + static_cast<unsigned>(c - '0');
+      in_number = true;
+
+    } else if (c == ' ' || c == '\t' || c == '\r') {
+      if (in_number)
+        task_mapping.push_back(pe);
+
+      pe = 0u;
+      in_number = false;
+
+    } else {
+      throw std::invalid_argument("malformed task mapping expression");
+    }
+  }
+
+  if (in_number)
+    task_mapping.push_back(pe);
+
+  if (it != last)
+    ++it;
+
+  return !task_mapping.empty();
+}
+
+// binary task mapping files need no parsing, slices of the memory mapped
+// file are passed to ArchGraphSystem::repr_batch directly
+profile::StreamStats stream_task_mapping_file(
+  std::string const &file,
+  std::shared_ptr<mpsym::ArchGraphSystem> ags,
+  mpsym::ReprOptions const &repr_options,
+  mpsym::TMORs &task_orbits,
+  profile::StreamOptions const &options)
+{
+  mpsym::TaskMappingView mappings(file);
+
+  if (options.task_mappings_limit > 0u &&
+      options.task_mappings_limit < mappings.size()) {
+    mappings = mappings.slice(0u, options.task_mappings_limit);
+  }
+
+  std::size_t row_bytes = std::max(mappings.num_tasks() * mappings.task_bytes(), 1u);
+  std::size_t slice_size = std::max(options.chunk_bytes / row_bytes,
+                                    static_cast<std::size_t>(1u));
+
+  profile::StreamStats stats;
+
+  for (std::size_t first = 0u; first < mappings.size(); first += slice_size) {
+    auto start = stream_clock::now();
+
+    auto slice(mappings.slice(first, std::min(slice_size, mappings.size() - first)));
+
+    ags->repr_batch(slice,
+                    nullptr,
+                    &task_orbits,
+                    nullptr,
+                    &repr_options,
+                    options.num_threads);
+
+    stats.repr.items += slice.size();
+    stats.repr.bytes += slice.size() * row_bytes;
+    stats.repr.seconds += seconds_since(start);
+  }
+
+  return stats;
+}
+
+} // anonymous namespace
+
+namespace profile
+{
+
+StreamStats stream_task_mappings(std::string const &file,
+                                 std::shared_ptr<mpsym::ArchGraphSystem> ags,
+                                 mpsym::ReprOptions const &repr_options,
+                                 mpsym::TMORs &task_orbits,
+                                 StreamOptions const &options)
+{
+  if (mpsym::TaskMappingView::is_task_mapping_file(file))
+    return stream_task_mapping_file(file, ags, repr_options, task_orbits, options);
+
+  MappedFile mapped_file(file);
+
+  StreamStats stats;
+
+  BoundedQueue<Chunk> chunks(options.queue_capacity);
+  BoundedQueue<Batch> batches(options.queue_capacity);
+
+  std::exception_ptr exception;
+  std::mutex exception_mtx;
+
+  auto fail = [&]{
+    {
+      std::lock_guard<std::mutex> lock(exception_mtx);
+      if (!exception)
+        exception = std::current_exception();
+    }
+
+    chunks.close();
+    batches.close();
+  };
+
+  // split the file into chunks ending at line boundaries
+  std::thread reader([&]{
+    try {
+      char const *data = mapped_file.data();
+      std::size_t size = mapped_file.size();
+
+      std::size_t offs = 0u;
+      while (offs < size) {
+        auto start = stream_clock::now();
+
+        std::size_t offs_next = std::min(offs + options.chunk_bytes, size);
+
+        if (offs_next < size) {
+          auto newline = static_cast<char const *>(
+            std::memchr(data + offs_next, '\n', size - offs_next));
+
+          offs_next = newline ? newline - data + 1u : size;
+        }
+
+        stats.read.items += 1u;
+        stats.read.bytes += offs_next - offs;
+        stats.read.seconds += seconds_since(start);
+
+        if (!chunks.push(Chunk{data + offs, data + offs_next}))
+          break;
+
+        offs = offs_next;
+      }
+
+      chunks.close();
+
+    } catch (...) {
+      fail();
+    }
+  });
+
+  // parse chunks into batches of task mappings
+  std::thread parser([&]{
+    try {
+      std::size_t num_task_mappings = 0u;
+      bool limit_reached = false;
+
+      Chunk chunk;
+      while (!limit_reached && chunks.pop(chunk)) {
+        auto start = stream_clock::now();
+
+        Batch batch;
+        mpsym::TaskMapping task_mapping;
+
+        char const *it = chunk.first;
+        while (it != chunk.last) {
+          if (!parse_task_mapping(it, chunk.last, task_mapping))
+            continue;
+
+          batch.push_back(task_mapping);
+
+          if (options.task_mappings_limit > 0u &&
+              ++num_task_mappings == options.task_mappings_limit) {
+            limit_reached = true;
+            break;
+          }
+        }
+
+        mapped_file.release(chunk.first, chunk.last);
+
+        stats.parse.items += batch.size();
+        stats.parse.bytes += it - chunk.first;
+        stats.parse.seconds += seconds_since(start);
+
+        if (!batches.push(std::move(batch)))
+          break;
+      }
+
+      // also stops the reader if the limit has been reached
+      chunks.close();
+      batches.close();
+
+    } catch (...) {
+      fail();
+    }
+  });
+
+  // determine representatives
+  try {
+    Batch batch;
+    Batch representatives;
+
+    while (batches.pop(batch)) {
+      auto start = stream_clock::now();
+
+      representatives.resize(batch.size());
+
+      ags->repr_batch(batch.data(),
+                      batch.size(),
+                      representatives.data(),
+                      task_orbits,
+                      nullptr,
+                      &repr_options,
+                      options.num_threads);
+
+      stats.repr.items += batch.size();
+      stats.repr.seconds += seconds_since(start);
+    }
+
+  } catch (...) {
+    fail();
+  }
+
+  reader.join();
+  parser.join();
+
+  if (exception)
+    std::rethrow_exception(exception);
+
+  return stats;
+}
+
+void dump_stream_stats(StreamStats const &stats)
+{
+  auto dump_stage = [](char const *stage, StageStats const &stage_stats){
+    double seconds = std::max(stage_stats.seconds, 1e-9);
+
+    double items_per_second = static_cast<double>(stage_stats.items) / seconds;
+
+    if (stage_stats.bytes == 0u) {
+      debug("Stage", stage,
+            "processed", stage_stats.items, "items",
+            "in", stage_stats.seconds, "s",
+            "=>", items_per_second, "items/s");
+    } else {
+      double mb_per_second = static_cast<double>(stage_stats.bytes) / seconds / 1e6;
+
+      debug("Stage", stage,
+            "processed", stage_stats.items, "items",
+            "(" + std::to_string(stage_stats.bytes) + " bytes)",
+            "in", stage_stats.seconds, "s",
+            "=>", items_per_second, "items/s,", mb_per_second, "MB/s");
+    }
+  };
+
+  dump_stage("read", stats.read);
+  dump_stage("parse", stats.parse);
+  dump_stage("repr", stats.repr);
+}
+
+} // namespace profile
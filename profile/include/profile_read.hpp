@@ -14,14 +14,16 @@ namespace profile
 struct Stream
 {
   std::ifstream stream;
+  std::string file;
   bool valid = false;
 
-  void open(char const *file)
+  void open(char const *file_)
   {
-    stream = std::ifstream(file);
+    stream = std::ifstream(file_);
     if (!stream)
       throw std::runtime_error("failed to open file");
 
+    file = file_;
     valid = true;
   }
 };
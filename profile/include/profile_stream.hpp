@@ -0,0 +1,127 @@
+#ifndef _GUARD_PROFILE_STREAM_H
+#define _GUARD_PROFILE_STREAM_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "arch_graph_system.hpp"
+#include "task_mapping_orbit.hpp"
+
+namespace profile
+{
+
+// fifo queue holding at most capacity elements, push blocks while the queue
+// is full and pop blocks while it is empty, once the queue has been closed
+// push fails and pop fails as soon as the queue has been drained
+template<typename T>
+class BoundedQueue
+{
+public:
+  explicit BoundedQueue(std::size_t capacity)
+  : _capacity(capacity)
+  {}
+
+  bool push(T value)
+  {
+    std::unique_lock<std::mutex> lock(_mtx);
+
+    _cv_not_full.wait(lock, [&]{ return _closed || _queue.size() < _capacity; });
+
+    if (_closed)
+      return false;
+
+    _queue.push_back(std::move(value));
+
+    _cv_not_empty.notify_one();
+
+    return true;
+  }
+
+  bool pop(T &value)
+  {
+    std::unique_lock<std::mutex> lock(_mtx);
+
+    _cv_not_empty.wait(lock, [&]{ return _closed || !_queue.empty(); });
+
+    if (_queue.empty())
+      return false;
+
+    value = std::move(_queue.front());
+    _queue.pop_front();
+
+    _cv_not_full.notify_one();
+
+    return true;
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    _closed = true;
+
+    _cv_not_full.notify_all();
+    _cv_not_empty.notify_all();
+  }
+
+private:
+  std::size_t _capacity;
+  std::deque<T> _queue;
+  bool _closed = false;
+
+  std::mutex _mtx;
+  std::condition_variable _cv_not_full;
+  std::condition_variable _cv_not_empty;
+};
+
+struct StreamOptions
+{
+  // the file is read in chunks of roughly this many bytes (ending at line
+  // boundaries), at most queue_capacity chunks and parsed batches are in
+  // flight at any time
+  std::size_t chunk_bytes = 1u << 24;
+  std::size_t queue_capacity = 4u;
+
+  unsigned task_mappings_limit = 0u;
+  unsigned num_threads = 0u;
+};
+
+struct StageStats
+{
+  std::size_t items = 0u;
+  std::size_t bytes = 0u;
+  double seconds = 0.0;
+};
+
+struct StreamStats
+{
+  StageStats read;
+  StageStats parse;
+  StageStats repr;
+};
+
+// determines the orbit representatives of all task mappings in file (one
+// mapping per line, tasks separated by spaces) without ever holding more
+// than a bounded part of it in memory, the file is memory mapped and split
+// into chunks by a reader thread, chunks are parsed into batches of task
+// mappings by a parser thread and these are finally passed to
+// ArchGraphSystem::repr_batch (using options.num_threads threads) by the
+// calling thread, binary task mapping files (see TaskMappingView) are passed
+// to ArchGraphSystem::repr_batch in slices of roughly options.chunk_bytes
+// bytes without parsing
+StreamStats stream_task_mappings(std::string const &file,
+                                 std::shared_ptr<mpsym::ArchGraphSystem> ags,
+                                 mpsym::ReprOptions const &repr_options,
+                                 mpsym::TMORs &task_orbits,
+                                 StreamOptions const &options);
+
+void dump_stream_stats(StreamStats const &stats);
+
+} // namespace profile
+
+#endif // _GUARD_PROFILE_STREAM_H
@@ -1,12 +1,14 @@
 #ifndef _GUARD_PROFILE_UTIL_H
 #define _GUARD_PROFILE_UTIL_H
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <sys/resource.h>
 #include <sys/types.h>
 
 #include "timer.hpp"
@@ -69,6 +71,19 @@ inline void debug_timer_dump(char const *timer)
   TIMER_SET_OUT(os);
 }
 
+inline void debug_peak_memory()
+{
+  // includes forked children, i.e. gap or runs timed with PROFILE_CPU_TIMER
+  struct rusage usage_self, usage_children;
+
+  getrusage(RUSAGE_SELF, &usage_self);
+  getrusage(RUSAGE_CHILDREN, &usage_children);
+
+  debug("Peak memory usage:",
+        std::max(usage_self.ru_maxrss, usage_children.ru_maxrss),
+        "KiB");
+}
+
 template<typename... ARGS>
 void warning(ARGS &&...args)
 { print(std::cerr, "WARNING:", "\n", std::forward<ARGS>(args)...); }
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
@@ -17,6 +18,7 @@
 #include <getopt.h>
 #include <libgen.h>
 
+#include "cached_transversals.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
@@ -43,8 +45,8 @@ void usage(std::ostream &s)
   char const *opts[] = {
     "[-h|--help]",
     "-i|--implementation  {gap|mpsym|permlib}",
-    "[-s|--schreier-sims] {deterministic|random|random-no-guarantee}",
-    "[-t|--transversals]  {explicit|schreier-trees|shallow-schreier-trees}",
+    "[-s|--schreier-sims] {deterministic|random|random-no-guarantee|parallel}",
+    "[-t|--transversals]  {explicit|schreier-trees|shallow-schreier-trees|cached}",
     "[--bsgs-options      {dont_check_sym,",
     "                      dont_reduce_gens,",
     "                      dont_use_known_order",
@@ -69,11 +71,13 @@ struct ProfileOptions
 {
   VariantOption implementation{"gap", "mpsym", "permlib"};
 
-  VariantOption schreier_sims{"deterministic", "random", "random-no-guarantee"};
+  VariantOption schreier_sims{"deterministic", "random", "random-no-guarantee",
+                             "parallel"};
 
   VariantOption transversals{"explicit",
                              "schreier-trees",
-                             "shallow-schreier-trees"};
+                             "shallow-schreier-trees",
+                             "cached"};
 
   VariantOptionSet bsgs_options{"dont_check_sym",
                                 "dont_reduce_gens",
@@ -106,6 +110,8 @@ mpsym::internal::BSGSOptions bsgs_options_mpsym(ProfileOptions const &options)
   } else if (options.schreier_sims.is("random-no-guarantee")) {
     bsgs_options.construction = BSGSOptions::Construction::SCHREIER_SIMS_RANDOM;
     bsgs_options.schreier_sims_random_guarantee = false;
+  } else if (options.schreier_sims.is("parallel")) {
+    bsgs_options.construction = BSGSOptions::Construction::SCHREIER_SIMS_PARALLEL;
   } else {
     throw std::logic_error("unreachable");
   }
@@ -116,6 +122,8 @@ mpsym::internal::BSGSOptions bsgs_options_mpsym(ProfileOptions const &options)
     bsgs_options.transversals = BSGSOptions::Transversals::SCHREIER_TREES;
   else if (options.transversals.is("shallow-schreier-trees"))
     bsgs_options.transversals = BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES;
+  else if (options.transversals.is("cached"))
+    bsgs_options.transversals = BSGSOptions::Transversals::CACHED;
   else
     throw std::logic_error("unreachable");
 
@@ -151,6 +159,42 @@ void make_perm_group_mpsym(mpsym::internal::PermSet const &generators,
   PermGroup g(BSGS(generators.degree(), generators, &bsgs_options));
 }
 
+void strip_latency_mpsym(mpsym::internal::PermSet const &generators,
+                         ProfileOptions const &options)
+{
+  using mpsym::internal::BSGS;
+  using mpsym::internal::Perm;
+  using mpsym::internal::PermGroup;
+
+  static constexpr unsigned num_strips = 1000u;
+
+  auto bsgs_options(bsgs_options_mpsym(options));
+
+  PermGroup g(BSGS(generators.degree(), generators, &bsgs_options));
+
+  std::vector<Perm> perms;
+  for (unsigned i = 0u; i < num_strips; ++i)
+    perms.push_back(g.random_element());
+
+  auto start(std::chrono::high_resolution_clock::now());
+
+  for (Perm const &perm : perms)
+    g.bsgs().strip(perm);
+
+  auto stop(std::chrono::high_resolution_clock::now());
+
+  std::chrono::duration<double, std::micro> t(stop - start);
+
+  debug("Average strip latency:", t.count() / num_strips, "us");
+
+  auto cache(g.bsgs().transversals_cache());
+  if (cache) {
+    debug("Transversal cache hits:", cache->hits());
+    debug("Transversal cache misses:", cache->misses());
+    debug("Transversal cache size:", cache->bytes(), "/", cache->max_bytes(), "B");
+  }
+}
+
 template <typename T>
 struct TypeTag { using type = T; };
 
@@ -232,6 +276,9 @@ std::vector<double> run_groups(unsigned degree,
             options.num_runs,
             &ts);
 
+    if (options.verbose)
+      strip_latency_mpsym(generators_mpsym, options);
+
   } else if (options.implementation.is("permlib")) {
     auto generators_permlib(parse_generators_permlib(degree, generators));
 
@@ -330,6 +377,9 @@ void run(FUNC &&f,
     debug_timer_dump("extend base");
     debug_timer_dump("update strong gens");
   }
+
+  if (options.verbose)
+    debug_peak_memory();
 }
 
 void do_profile(Stream &automorphisms_stream,
@@ -476,6 +526,14 @@ int main(int argc, char **argv)
   CHECK_OPTION((options.implementation.is("gap") || options.transversals.is_set()),
                "--transversal-storage option is mandatory when not using gap");
 
+  CHECK_OPTION((!options.implementation.is("permlib") ||
+                !options.schreier_sims.is("parallel")),
+               "permlib does not implement parallel Schreier-Sims");
+
+  CHECK_OPTION((!options.implementation.is("permlib") ||
+                !options.transversals.is("cached")),
+               "permlib does not implement cached transversals");
+
   CHECK_OPTION(options.groups_input != options.arch_graph_input,
                "EITHER --arch-graph OR --groups must be given");
 
@@ -15,6 +15,8 @@
 #include "arch_graph_system.hpp"
 #include "dump.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
+#include "task_mapping_orbit.hpp"
 #include "task_orbits.hpp"
 #include "timer.hpp"
 
@@ -22,6 +24,7 @@
 #include "profile_parse.hpp"
 #include "profile_read.hpp"
 #include "profile_run.hpp"
+#include "profile_stream.hpp"
 #include "profile_util.hpp"
 
 using namespace profile;
@@ -36,8 +39,8 @@ void usage(std::ostream &s)
   char const *opts[] = {
     "[-h|--help]",
     "-i|--implementation {gap|mpsym}",
-    "-m|--repr-method {iterate|orbits|local_search}",
-    "--repr-variant {local_search_bfs|local_search_dfs|local_search_sa_linear}",
+    "-m|--repr-method {iterate|orbits|local_search|backtrack|stabilizer_chain}",
+    "--repr-variant {local_search_bfs|local_search_dfs|local_search_sa_linear|local_search_multi_start}",
     "--repr-local-search-invert-generators",
     "--repr-local-search-append-generators",
     "--repr-local-search-iterations",
@@ -49,6 +52,9 @@ void usage(std::ostream &s)
     "[--dont-decompose-arch-graph]",
     "-t|--task-mappings TASK_ALLOCATIONS",
     "[-l|--task-mappings-limit TASK_ALLOCATIONS_LIMIT]",
+    "[--stream-task-mappings]",
+    "[--stream-num-threads NUM_THREADS]",
+    "[--save-task-mappings TASK_MAPPINGS_FILE]",
     "[-r|--num-runs NUM_RUNS]",
     "[--num-discarded-runs NUM_DISCARDED_RUNS]",
     "[--summarize-runs]",
@@ -67,9 +73,11 @@ void usage(std::ostream &s)
 struct ProfileOptions
 {
   VariantOption library{"gap", "mpsym"};
-  VariantOption repr_method{"iterate", "orbits", "local_search"};
+  VariantOption repr_method{
+    "iterate", "orbits", "local_search", "backtrack", "stabilizer_chain"};
   VariantOption repr_variant{
-    "local_search_bfs", "local_search_dfs", "local_search_sa_linear"};
+    "local_search_bfs", "local_search_dfs", "local_search_sa_linear",
+    "local_search_multi_start"};
   VariantOptionSet repr_options{
     "dont_decompose", "dont_match", "dont_optimize_symmetric"};
 
@@ -83,6 +91,9 @@ struct ProfileOptions
   std::vector<std::string> arch_graph_args;
   bool dont_decompose_arch_graph = false;
   unsigned task_mappings_limit = 0u;
+  bool stream_task_mappings = false;
+  unsigned stream_num_threads = 0u;
+  std::string save_task_mappings;
   unsigned num_runs = 1u;
   unsigned num_discarded_runs = 0u;
   bool summarize_runs = false;
@@ -260,6 +271,10 @@ mpsym::ReprOptions map_tasks_mpsym_repr_options(
     repr_options.method = ReprOptions::Method::ITERATE;
   } else if (options.repr_method.is("orbits")) {
     repr_options.method = ReprOptions::Method::ORBITS;
+  } else if (options.repr_method.is("backtrack")) {
+    repr_options.method = ReprOptions::Method::BACKTRACK;
+  } else if (options.repr_method.is("stabilizer_chain")) {
+    repr_options.method = ReprOptions::Method::STABILIZER_CHAIN;
   } else if (options.repr_method.is("local_search")) {
     repr_options.method = ReprOptions::Method::LOCAL_SEARCH;
 
@@ -269,6 +284,8 @@ mpsym::ReprOptions map_tasks_mpsym_repr_options(
       repr_options.variant = ReprOptions::Variant::LOCAL_SEARCH_DFS;
     else if (options.repr_variant.is("local_search_sa_linear"))
       repr_options.variant = ReprOptions::Variant::LOCAL_SEARCH_SA_LINEAR;
+    else if (options.repr_variant.is("local_search_multi_start"))
+      repr_options.variant = ReprOptions::Variant::LOCAL_SEARCH_MULTI_START;
 
     repr_options.local_search_invert_generators =
       options.repr_local_search_invert_generators;
@@ -502,6 +519,53 @@ void run(std::shared_ptr<mpsym::ArchGraphSystem> ags,
   dump_runs(ts, options.summarize_runs);
 }
 
+void run_stream(std::shared_ptr<mpsym::ArchGraphSystem> ags,
+                std::string const &task_mappings_file,
+                ProfileOptions const &options)
+{
+  auto repr_options(map_tasks_mpsym_repr_options(options));
+
+  StreamOptions stream_options;
+  stream_options.task_mappings_limit = options.task_mappings_limit;
+  stream_options.num_threads = options.stream_num_threads;
+
+  if (options.verbosity > 0)
+    debug("Constructing BSGS");
+
+  ags->init_repr();
+
+  if (options.verbosity > 0)
+    debug("Automorphism group has size", ags->num_automorphisms());
+
+  std::vector<double> ts;
+
+  StreamStats stream_stats;
+  unsigned num_orbits = 0u;
+
+  run_cpp([&]{
+            mpsym::TMORs task_orbits;
+
+            stream_stats = stream_task_mappings(task_mappings_file,
+                                                ags,
+                                                repr_options,
+                                                task_orbits,
+                                                stream_options);
+
+            num_orbits = task_orbits.num_orbits();
+          },
+          options.num_discarded_runs,
+          options.num_runs,
+          &ts);
+
+  if (options.verbosity > 0) {
+    debug("=> Found", num_orbits, "orbit representatives");
+
+    dump_stream_stats(stream_stats);
+  }
+
+  dump_runs(ts, options.summarize_runs);
+}
+
 void do_profile(Stream &automorphisms_stream,
                 Stream &task_mappings_stream,
                 ProfileOptions const &options)
@@ -511,8 +575,25 @@ void do_profile(Stream &automorphisms_stream,
 
   std::shared_ptr<ArchGraphSystem> ags, ags_check;
 
-  auto task_mappings(read_file(task_mappings_stream.stream,
-                               options.task_mappings_limit));
+  // task mappings are not read into memory at once when streaming them
+  std::string task_mappings;
+
+  if (!options.stream_task_mappings) {
+    if (mpsym::TaskMappingView::is_task_mapping_file(task_mappings_stream.file))
+      throw std::runtime_error("binary task mapping files can only be streamed");
+
+    task_mappings = read_file(task_mappings_stream.stream,
+                              options.task_mappings_limit);
+
+    // convert to a binary task mapping file which can later be streamed
+    if (!options.save_task_mappings.empty()) {
+      auto task_mappings_mpsym(parse_task_mappings_mpsym(task_mappings));
+
+      mpsym::TaskMappingView::save(options.save_task_mappings,
+                                   task_mappings_mpsym.data(),
+                                   task_mappings_mpsym.size());
+    }
+  }
 
   if (options.verbosity > 0)
     debug("Implementation:", options.library.get());
@@ -552,7 +633,10 @@ void do_profile(Stream &automorphisms_stream,
     }
   }
 
-  run(ags, ags_check, task_mappings, options);
+  if (options.stream_task_mappings)
+    run_stream(ags, task_mappings_stream.file, options);
+  else
+    run(ags, ags_check, task_mappings, options);
 }
 
 } // namespace
@@ -580,6 +664,9 @@ int main(int argc, char **argv)
     {"dont-decompose-arch-graph",           no_argument, 0,              8 },
     {"task-mappings",                       required_argument, 0,       't'},
     {"task-mappings-limit",                 required_argument, 0,       'l'},
+    {"stream-task-mappings",                no_argument,       0,        14},
+    {"stream-num-threads",                  required_argument, 0,        15},
+    {"save-task-mappings",                  required_argument, 0,        16},
     {"num-runs",                            required_argument, 0,       'r'},
     {"num-discarded-runs",                  required_argument, 0,        9 },
     {"summarize-runs",                      required_argument, 0,        10},
@@ -679,6 +766,15 @@ int main(int argc, char **argv)
       case 13:
         options.show_gap_errors = true;
         break;
+      case 14:
+        options.stream_task_mappings = true;
+        break;
+      case 15:
+        options.stream_num_threads = stox<unsigned>(optarg);
+        break;
+      case 16:
+        options.save_task_mappings = optarg;
+        break;
       default:
         return EXIT_FAILURE;
       }
@@ -698,10 +794,26 @@ int main(int argc, char **argv)
   CHECK_OPTION(options.groups_input != options.arch_graph_input,
                "EITHER --arch-graph OR --groups must be given");
 
+  CHECK_OPTION(!options.library.is("gap") ||
+               !options.repr_method.is("backtrack"),
+               "backtracking only available when using mpsym");
+
+  CHECK_OPTION(!options.library.is("gap") ||
+               !options.repr_method.is("stabilizer_chain"),
+               "stabilizer chain only available when using mpsym");
+
   CHECK_OPTION(!options.library.is("gap") ||
                !(options.check_accuracy_gap || options.check_accuracy_mpsym),
                "--check-accuracy-* only available when using mpsym");
 
+  CHECK_OPTION(!options.stream_task_mappings ||
+               (options.library.is("mpsym") &&
+                !(options.check_accuracy_gap || options.check_accuracy_mpsym)),
+               "--stream-task-mappings only available when using mpsym without --check-accuracy-*");
+
+  CHECK_OPTION(!options.stream_task_mappings || options.save_task_mappings.empty(),
+               "--save-task-mappings not available when using --stream-task-mappings");
+
   try {
     do_profile(automorphisms_stream, task_mappings_stream, options);
   } catch (std::exception const &e) {
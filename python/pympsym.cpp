@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <memory>
@@ -17,6 +18,7 @@
 #include <boost/multiprecision/cpp_int.hpp>
 
 #include <nlohmann/json.hpp>
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
@@ -33,6 +35,7 @@
 #include "perm_group.hpp"
 #include "perm_set.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
 #include "task_mapping_orbit.hpp"
 #include "timeout.hpp"
 #include "util.hpp"
@@ -51,6 +54,7 @@ using mpsym::ArchGraphSystem;
 using mpsym::ArchUniformSuperGraph;
 using mpsym::ReprOptions;
 using mpsym::TaskMapping;
+using mpsym::TaskMappingView;
 using mpsym::TMO;
 using mpsym::TMORs;
 
@@ -67,6 +71,7 @@ using mpsym::util::stream;
 
 using mpsym::internal::timeout::flag;
 using mpsym::internal::timeout::run_abortable_with_timeout;
+using mpsym::internal::timeout::run_abortable_with_timeout_threaded;
 using mpsym::internal::timeout::TimeoutError;
 
 namespace
@@ -75,6 +80,11 @@ namespace
 template<typename T = unsigned>
 using Sequence = std::vector<T>;
 
+// task mappings stored row by row, arrays of other types or memory layouts
+// are converted once as a whole
+using MappingArray = py::array_t<unsigned,
+                                 py::array::c_style | py::array::forcecast>;
+
 template<typename T>
 using contained_type =
   typename std::remove_reference<decltype(*std::declval<T>().begin())>::type;
@@ -122,12 +132,19 @@ ReprOptions str_to_repr_options(std::string const &method)
     options.method = ReprOptions::Method::ITERATE;
   } else if (method == "orbit") {
     options.method = ReprOptions::Method::ORBITS;
+  } else if (method == "backtrack") {
+    options.method = ReprOptions::Method::BACKTRACK;
+  } else if (method == "stabilizer_chain") {
+    options.method = ReprOptions::Method::STABILIZER_CHAIN;
   } else if (method == "local_search_bfs") {
     options.method = ReprOptions::Method::LOCAL_SEARCH;
     options.variant = ReprOptions::Variant::LOCAL_SEARCH_BFS;
   } else if (method == "local_search_dfs") {
     options.method = ReprOptions::Method::LOCAL_SEARCH;
     options.variant = ReprOptions::Variant::LOCAL_SEARCH_DFS;
+  } else if (method == "local_search_multi_start") {
+    options.method = ReprOptions::Method::LOCAL_SEARCH;
+    options.variant = ReprOptions::Variant::LOCAL_SEARCH_MULTI_START;
   } else {
     throw std::invalid_argument("invalid 'method'");
   }
@@ -163,11 +180,111 @@ arch_graph_timeout(std::string const &what,
                    FUNC f,
                    ARGS &&...args)
 {
+  auto f_abortable = [&](flag aborted)
+  { return (self.*f)(std::forward<ARGS>(args)..., aborted); };
+
+  // automorphisms are determined using nauty first, which cannot be aborted
+  if (!self.automorphisms_ready()) {
+    return run_abortable_with_timeout_threaded(
+      what, std::chrono::duration<double>(timeout), f_abortable);
+  }
+
   return run_abortable_with_timeout(
-    what,
-    std::chrono::duration<double>(timeout),
-    [&](flag aborted)
-    { return (self.*f)(std::forward<ARGS>(args)..., aborted); });
+    what, std::chrono::duration<double>(timeout), f_abortable);
+}
+
+MappingArray to_mapping_array(py::array const &mappings)
+{
+  if (mappings.ndim() != 2)
+    throw std::invalid_argument("mappings must be a two-dimensional array");
+
+  auto res(MappingArray::ensure(mappings));
+  if (!res)
+    throw std::invalid_argument("mappings must contain unsigned integers");
+
+  return res;
+}
+
+void repr_batch_flat(ArchGraphSystem &self,
+                     unsigned const *mappings,
+                     std::size_t num_mappings,
+                     std::size_t mapping_size,
+                     unsigned *representatives,
+                     TMORs *orbits,
+                     unsigned *orbit_indices,
+                     ReprOptions const &options,
+                     unsigned num_threads,
+                     double timeout)
+{
+  using T = void(ArchGraphSystem::*)(unsigned const *,
+                                     std::size_t,
+                                     std::size_t,
+                                     unsigned *,
+                                     TMORs *,
+                                     unsigned *,
+                                     ReprOptions const *,
+                                     unsigned,
+                                     flag);
+
+  // no python objects are accessed from here on
+  py::gil_scoped_release release;
+
+  arch_graph_timeout("representatives",
+                     timeout,
+                     self,
+                     (T)&ArchGraphSystem::repr_batch_flat,
+                     mappings,
+                     num_mappings,
+                     mapping_size,
+                     representatives,
+                     orbits,
+                     orbit_indices,
+                     &options,
+                     num_threads);
+}
+
+MappingArray repr_batch_view(ArchGraphSystem &self,
+                             TaskMappingView const &mappings,
+                             TMORs *orbits,
+                             unsigned *orbit_indices,
+                             ReprOptions const &options,
+                             unsigned num_threads,
+                             double timeout)
+{
+  using T = void(ArchGraphSystem::*)(TaskMappingView const &,
+                                     TaskMapping *,
+                                     TMORs *,
+                                     unsigned *,
+                                     ReprOptions const *,
+                                     unsigned,
+                                     flag);
+
+  std::vector<TaskMapping> reprs(mappings.size());
+
+  {
+    // no python objects are accessed from here on
+    py::gil_scoped_release release;
+
+    arch_graph_timeout("representatives",
+                       timeout,
+                       self,
+                       (T)&ArchGraphSystem::repr_batch,
+                       mappings,
+                       reprs.data(),
+                       orbits,
+                       orbit_indices,
+                       &options,
+                       num_threads);
+  }
+
+  std::size_t mapping_size = mappings.num_tasks();
+
+  MappingArray res({mappings.size(), mapping_size});
+
+  for (std::size_t i = 0u; i < reprs.size(); ++i)
+    std::copy(reprs[i].begin(), reprs[i].end(), res.mutable_data() + i * mapping_size);
+
+  return res;
 }
 
 } // anonymous namespace
@@ -281,6 +398,11 @@ PYBIND11_MODULE_(PYTHON_MODULE, m)
     .def_static("from_json_file", &ArchGraphSystem::from_json_file,
                 "json_file"_a)
     .def("to_json", &ArchGraphSystem::to_json)
+    .def_static("set_automorphisms_cache_dir",
+                &ArchGraphSystem::set_automorphisms_cache_dir,
+                "dir"_a)
+    .def_static("automorphisms_cache_dir",
+                &ArchGraphSystem::automorphisms_cache_dir)
     .def("processor_types",
          [](ArchGraphSystem const &self)
          {
@@ -413,7 +535,199 @@ PYBIND11_MODULE_(PYTHON_MODULE, m)
                                   orbit_new,
                                   orbit_index);
          },
-         "mapping"_a, "representatives"_a, "method"_a = "auto", "timeout"_a = 0.0);
+         "mapping"_a, "representatives"_a, "method"_a = "auto", "timeout"_a = 0.0)
+    // mapping file and numpy overloads must precede the sequence overloads
+    // below since both are also convertible to sequences, no python objects
+    // are created per mapping
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             TaskMappingView const &mappings,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           auto options(str_to_repr_options(method));
+
+           return repr_batch_view(self,
+                                  mappings,
+                                  nullptr,
+                                  nullptr,
+                                  options,
+                                  num_threads,
+                                  timeout);
+         },
+         "mappings"_a, "method"_a = "auto", "num_threads"_a = 0u, "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             TaskMappingView const &mappings,
+             TMORs &representatives,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           auto options(str_to_repr_options(method));
+
+           py::array_t<unsigned> orbit_indices(mappings.size());
+
+           auto reprs(repr_batch_view(self,
+                                      mappings,
+                                      &representatives,
+                                      orbit_indices.mutable_data(),
+                                      options,
+                                      num_threads,
+                                      timeout));
+
+           return py::make_tuple(reprs, orbit_indices);
+         },
+         "mappings"_a, "representatives"_a, "method"_a = "auto", "num_threads"_a = 0u, "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             py::array const &mappings_,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           auto options(str_to_repr_options(method));
+
+           auto mappings(to_mapping_array(mappings_));
+
+           std::size_t num_mappings = mappings.shape(0);
+           std::size_t mapping_size = mappings.shape(1);
+
+           MappingArray reprs({num_mappings, mapping_size});
+
+           repr_batch_flat(self,
+                           mappings.data(),
+                           num_mappings,
+                           mapping_size,
+                           reprs.mutable_data(),
+                           nullptr,
+                           nullptr,
+                           options,
+                           num_threads,
+                           timeout);
+
+           return reprs;
+         },
+         "mappings"_a, "method"_a = "auto", "num_threads"_a = 0u, "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             py::array const &mappings_,
+             TMORs &representatives,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           auto options(str_to_repr_options(method));
+
+           auto mappings(to_mapping_array(mappings_));
+
+           std::size_t num_mappings = mappings.shape(0);
+           std::size_t mapping_size = mappings.shape(1);
+
+           MappingArray reprs({num_mappings, mapping_size});
+           py::array_t<unsigned> orbit_indices(num_mappings);
+
+           repr_batch_flat(self,
+                           mappings.data(),
+                           num_mappings,
+                           mapping_size,
+                           reprs.mutable_data(),
+                           &representatives,
+                           orbit_indices.mutable_data(),
+                           options,
+                           num_threads,
+                           timeout);
+
+           return py::make_tuple(reprs, orbit_indices);
+         },
+         "mappings"_a, "representatives"_a, "method"_a = "auto", "num_threads"_a = 0u, "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             Sequence<Sequence<>> const &mappings,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           using T = void(ArchGraphSystem::*)(TaskMapping const *,
+                                              std::size_t,
+                                              TaskMapping *,
+                                              ReprOptions const *,
+                                              unsigned,
+                                              flag);
+
+           auto options(str_to_repr_options(method));
+
+           std::vector<TaskMapping> mappings_(mappings.begin(), mappings.end());
+           std::vector<TaskMapping> reprs(mappings_.size());
+
+           {
+             py::gil_scoped_release release;
+
+             arch_graph_timeout("representatives",
+                                timeout,
+                                self,
+                                (T)&ArchGraphSystem::repr_batch,
+                                mappings_.data(),
+                                mappings_.size(),
+                                reprs.data(),
+                                &options,
+                                num_threads);
+           }
+
+           py::list ret;
+           for (auto const &repr : reprs)
+             ret.append(to_tuple(repr));
+
+           return ret;
+         },
+         "mappings"_a, "method"_a = "auto", "num_threads"_a = 0u, "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             Sequence<Sequence<>> const &mappings,
+             TMORs &representatives,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           using T = void(ArchGraphSystem::*)(TaskMapping const *,
+                                              std::size_t,
+                                              TaskMapping *,
+                                              TMORs &,
+                                              unsigned *,
+                                              ReprOptions const *,
+                                              unsigned,
+                                              flag);
+
+           auto options(str_to_repr_options(method));
+
+           std::vector<TaskMapping> mappings_(mappings.begin(), mappings.end());
+           std::vector<TaskMapping> reprs(mappings_.size());
+           std::vector<unsigned> orbit_indices(mappings_.size());
+
+           {
+             py::gil_scoped_release release;
+
+             arch_graph_timeout("representatives",
+                                timeout,
+                                self,
+                                (T)&ArchGraphSystem::repr_batch,
+                                mappings_.data(),
+                                mappings_.size(),
+                                reprs.data(),
+                                representatives,
+                                orbit_indices.data(),
+                                &options,
+                                num_threads);
+           }
+
+           py::list ret;
+           for (auto i = 0u; i < reprs.size(); ++i)
+             ret.append(py::make_tuple(to_tuple(reprs[i]), orbit_indices[i]));
+
+           return ret;
+         },
+         "mappings"_a, "representatives"_a, "method"_a = "auto", "num_threads"_a = 0u, "timeout"_a = 0.0);
 
   // ArchGraphAutomorphisms
   py::class_<ArchGraphAutomorphisms,
@@ -570,6 +884,9 @@ PYBIND11_MODULE_(PYTHON_MODULE, m)
 
   // TMO
   py::class_<TMO>(m, "Orbit")
+    .def("__len__",
+         [](TMO const &orbit)
+         { return orbit.size(); })
     .def("__iter__",
          [](TMO &orbit)
          {
@@ -582,6 +899,7 @@ PYBIND11_MODULE_(PYTHON_MODULE, m)
   // TMORs
   py::class_<TMORs>(m, "Representatives")
     .def(py::init<>())
+    .def(py::init<std::string const &>(), "spill_directory"_a)
     .def(py::self == py::self)
     .def(py::self != py::self)
     .def("__len__", &TMORs::num_orbits)
@@ -592,7 +910,69 @@ PYBIND11_MODULE_(PYTHON_MODULE, m)
     .def("__contains__",
          [](TMORs const &orbits, Sequence<> const &mapping)
          { return orbits.is_repr(mapping); },
-         "mapping"_a);
+         "mapping"_a)
+    .def_property("memo_capacity",
+                  &TMORs::memo_capacity,
+                  &TMORs::set_memo_capacity)
+    .def("memo_stats",
+         [](TMORs const &orbits)
+         {
+           auto stats(orbits.memo_stats());
+
+           return py::dict("hits"_a = stats.hits,
+                           "misses"_a = stats.misses,
+                           "evictions"_a = stats.evictions,
+                           "size"_a = orbits.memo() ? orbits.memo()->size() : 0u,
+                           "capacity"_a = orbits.memo_capacity());
+         });
+
+  // TaskMappingView
+  py::class_<TaskMappingView>(m, "MappingFile")
+    .def(py::init<std::string const &>(), "file"_a)
+    .def_static("save",
+                [](std::string const &file,
+                   py::array const &mappings_,
+                   unsigned num_processors)
+                {
+                  auto mappings(to_mapping_array(mappings_));
+
+                  TaskMappingView::save_flat(file,
+                                             mappings.data(),
+                                             mappings.shape(0),
+                                             mappings.shape(1),
+                                             num_processors);
+                },
+                "file"_a, "mappings"_a, "num_processors"_a = 0u)
+    .def_static("save",
+                [](std::string const &file,
+                   Sequence<Sequence<>> const &mappings,
+                   unsigned num_processors)
+                {
+                  std::vector<TaskMapping> mappings_(mappings.begin(), mappings.end());
+
+                  TaskMappingView::save(file,
+                                        mappings_.data(),
+                                        mappings_.size(),
+                                        num_processors);
+                },
+                "file"_a, "mappings"_a, "num_processors"_a = 0u)
+    .def_static("is_mapping_file", &TaskMappingView::is_task_mapping_file, "file"_a)
+    .def_property_readonly("num_tasks", &TaskMappingView::num_tasks)
+    .def_property_readonly("num_processors", &TaskMappingView::num_processors)
+    .def("__len__", &TaskMappingView::size)
+    .def("__getitem__",
+         [](TaskMappingView const &mappings, long i)
+         {
+           if (i < 0)
+             i += static_cast<long>(mappings.size());
+
+           if (i < 0 || static_cast<std::size_t>(i) >= mappings.size())
+             throw py::index_error("mapping index out of range");
+
+           return to_tuple(mappings[i]);
+         },
+         "i"_a)
+    .def("slice", &TaskMappingView::slice, "first"_a, "num_mappings"_a);
 
   // Perm
   py::class_<Perm>(m, "Perm")
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "arch_graph_cluster.hpp"
@@ -11,12 +13,19 @@
 #include "perm_set.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
+#include "thread_pool.hpp"
 
 namespace mpsym
 {
 
 using namespace internal;
 
+ArchGraphCluster::ArchGraphCluster()
+: _repr_pool(std::make_shared<SharedThreadPool>())
+{}
+
+ArchGraphCluster::~ArchGraphCluster() = default;
+
 std::string
 ArchGraphCluster::to_gap() const
 {
@@ -72,19 +81,53 @@ ArchGraphCluster::num_subsystems() const
 { return static_cast<unsigned>(_subsystems.size()); }
 
 
+std::vector<std::vector<unsigned>>
+ArchGraphCluster::subsystem_groups() const
+{
+  std::vector<std::vector<unsigned>> groups;
+  std::unordered_map<ArchGraphSystem const *, unsigned> group_indices;
+
+  for (auto i = 0u; i < _subsystems.size(); ++i) {
+    auto it(group_indices.find(_subsystems[i].get()));
+
+    if (it == group_indices.end()) {
+      group_indices[_subsystems[i].get()] = static_cast<unsigned>(groups.size());
+      groups.push_back({i});
+    } else {
+      groups[it->second].push_back(i);
+    }
+  }
+
+  return groups;
+}
+
 PermGroup
 ArchGraphCluster::automorphisms_(AutomorphismOptions const *options,
                                  timeout::flag aborted)
 {
   assert(!_subsystems.empty());
 
+  auto groups(subsystem_groups());
+
   std::vector<PermGroup> automorphisms(_subsystems.size());
-  for (auto i = 0u; i < _subsystems.size(); ++i)
-    automorphisms[i] = _subsystems[i]->automorphisms(options);
+
+  // nauty calls are serialized, see ArchGraph::automorphisms_nauty
+  ThreadPool pool(std::min(static_cast<unsigned>(groups.size()),
+                           ThreadPool::default_num_threads()));
+
+  pool.parallel_for(groups.size(), [&](std::size_t i){
+    auto const &group(groups[i]);
+
+    auto automorphisms_group(_subsystems[group[0]]->automorphisms(options, aborted));
+
+    for (unsigned j : group)
+      automorphisms[j] = automorphisms_group;
+  });
 
   return PermGroup::direct_product(automorphisms.begin(),
                                    automorphisms.end(),
-                                   options);
+                                   options,
+                                   aborted);
 }
 
 TaskMapping
@@ -97,6 +140,9 @@ ArchGraphCluster::repr_(TaskMapping const &mapping_,
 
   assert(_subsystems.size() > 0u);
 
+  if (options.cluster_num_threads != 1u && _subsystems.size() > 1u)
+    return repr_parallel(mapping_, options, aborted);
+
   TaskMapping mapping(mapping_);
 
   for (auto i = 0u; i < _subsystems.size(); ++i) {
@@ -108,4 +154,63 @@ ArchGraphCluster::repr_(TaskMapping const &mapping_,
   return mapping;
 }
 
+TaskMapping
+ArchGraphCluster::repr_parallel(TaskMapping const &mapping,
+                                ReprOptions const &options,
+                                timeout::flag aborted)
+{
+  // every subsystem only permutes the tasks mapped to its own processors,
+  // so the mapping can be split into independent submappings
+  std::vector<unsigned> offsets;
+
+  unsigned offset = options.offset;
+  for (auto const &subsystem : _subsystems) {
+    offsets.push_back(offset);
+    offset += subsystem->num_processors();
+  }
+
+  std::vector<std::vector<unsigned>> positions(_subsystems.size());
+  std::vector<TaskMapping> submappings(_subsystems.size());
+
+  for (auto i = 0u; i < mapping.size(); ++i) {
+    unsigned task = mapping[i];
+
+    if (task < options.offset || task >= offset)
+      continue;
+
+    auto j = static_cast<unsigned>(
+      std::upper_bound(offsets.begin(), offsets.end(), task) - offsets.begin() - 1);
+
+    positions[j].push_back(i);
+    submappings[j].push_back(task - offsets[j]);
+  }
+
+  auto suboptions(options);
+  suboptions.offset = 0u;
+
+  auto groups(subsystem_groups());
+
+  auto repr_group = [&](std::size_t i){
+    for (unsigned j : groups[i]) {
+      if (!submappings[j].empty())
+        submappings[j] = _subsystems[j]->repr(submappings[j], &suboptions, aborted);
+    }
+  };
+
+  // fall back to sequential execution if the pool is in use, e.g. because
+  // several mappings are processed concurrently by repr_batch
+  _repr_pool->lease(options.cluster_num_threads)
+             .parallel_for(groups.size(), repr_group);
+
+  // merge
+  TaskMapping res(mapping);
+
+  for (auto j = 0u; j < _subsystems.size(); ++j) {
+    for (auto k = 0u; k < positions[j].size(); ++k)
+      res[positions[j][k]] = submappings[j][k] + offsets[j];
+  }
+
+  return res;
+}
+
 } // namespace mpsym
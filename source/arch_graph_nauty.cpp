@@ -1,4 +1,10 @@
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <boost/graph/adjacency_list.hpp>
@@ -9,8 +15,112 @@ extern "C" {
 }
 
 #include "arch_graph.hpp"
+#include "bsgs.hpp"
+#include "dbg.hpp"
 #include "nauty_graph.hpp"
+#include "perm.hpp"
 #include "perm_group.hpp"
+#include "perm_set.hpp"
+#include "util.hpp"
+
+namespace
+{
+
+using namespace mpsym::internal;
+
+// bases and strong generating sets of the automorphism groups of all canonical
+// graphs encountered so far, in terms of the canonical labeling
+using canonical_bsgs_type = std::pair<BSGS::Base, PermSet>;
+
+// nauty keeps its workspace in global variables unless built thread safe
+std::mutex _nauty_mtx;
+
+std::mutex _canonical_cache_mtx;
+std::unordered_map<std::string, canonical_bsgs_type> _canonical_cache;
+unsigned long _canonical_cache_hits = 0ul;
+
+std::string canonical_cache_file(std::string const &canonical_graph)
+{
+  std::stringstream ss;
+  ss << mpsym::ArchGraphSystem::automorphisms_cache_dir() << "/canon-"
+     << std::hex << std::setw(16) << std::setfill('0')
+     << mpsym::util::stable_hash(canonical_graph) << ".bsgs";
+
+  return ss.str();
+}
+
+bool canonical_cache_find(std::string const &canonical_graph,
+                          canonical_bsgs_type &bsgs)
+{
+  {
+    std::lock_guard<std::mutex> lock(_canonical_cache_mtx);
+
+    auto it(_canonical_cache.find(canonical_graph));
+    if (it != _canonical_cache.end()) {
+      bsgs = it->second;
+      ++_canonical_cache_hits;
+      return true;
+    }
+  }
+
+  if (mpsym::ArchGraphSystem::automorphisms_cache_dir().empty())
+    return false;
+
+  // the file name is only a hash of the canonical graph, the canonical graph
+  // itself is stored in the file and checked when loading it
+  try {
+    auto bsgs_loaded(BSGS::load(canonical_cache_file(canonical_graph),
+                                canonical_graph));
+
+    bsgs = {bsgs_loaded.base(), bsgs_loaded.strong_generators()};
+  } catch (std::runtime_error const &) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(_canonical_cache_mtx);
+
+  _canonical_cache.emplace(canonical_graph, bsgs);
+  ++_canonical_cache_hits;
+
+  return true;
+}
+
+void canonical_cache_insert(std::string const &canonical_graph,
+                            canonical_bsgs_type const &bsgs,
+                            unsigned degree)
+{
+  {
+    std::lock_guard<std::mutex> lock(_canonical_cache_mtx);
+
+    _canonical_cache.emplace(canonical_graph, bsgs);
+  }
+
+  if (mpsym::ArchGraphSystem::automorphisms_cache_dir().empty())
+    return;
+
+  try {
+    BSGS(degree, bsgs.first, bsgs.second).save(
+      canonical_cache_file(canonical_graph), canonical_graph);
+  } catch (std::runtime_error const &e) {
+    DBG(WARN) << "Failed to cache automorphisms: " << e.what();
+  }
+}
+
+canonical_bsgs_type conjugate_bsgs(canonical_bsgs_type const &bsgs,
+                                   Perm const &conj)
+{
+  canonical_bsgs_type res;
+
+  for (unsigned b : bsgs.first)
+    res.first.push_back(conj[b]);
+
+  for (Perm const &sg : bsgs.second)
+    res.second.insert(~conj * sg * conj);
+
+  return res;
+}
+
+} // anonymous namespace
 
 namespace mpsym
 {
@@ -78,15 +188,67 @@ PermSet ArchGraph::automorphism_generators_nauty()
 {
   auto g(graph_nauty());
 
+  std::lock_guard<std::mutex> lock(_nauty_mtx);
+
   return g.automorphism_generators();
 }
 
 PermGroup ArchGraph::automorphisms_nauty(AutomorphismOptions const *options,
                                          timeout::flag aborted)
 {
-  auto generators(automorphism_generators_nauty());
+  auto g(graph_nauty());
+
+  std::vector<int> canonical_labeling;
+  std::string canonical_graph;
+
+  PermSet generators;
+
+  {
+    std::lock_guard<std::mutex> lock(_nauty_mtx);
+
+    generators = g.automorphism_generators(canonical_labeling, canonical_graph);
+  }
+
+  // processors precede all other vertices in the partition, so the canonical
+  // labeling restricted to them maps canonical processors to processors
+  std::vector<unsigned> lab(canonical_labeling.begin(),
+                            canonical_labeling.begin() + num_processors());
+
+  Perm to_graph(lab);
+
+  canonical_bsgs_type bsgs;
+
+  if (canonical_cache_find(canonical_graph, bsgs)) {
+    bsgs = conjugate_bsgs(bsgs, to_graph);
+
+    return PermGroup(BSGS(num_processors(), bsgs.first, bsgs.second, options));
+  }
+
+  BSGS bsgs_graph(num_processors(), generators, options, aborted);
+
+  canonical_cache_insert(
+    canonical_graph,
+    conjugate_bsgs({bsgs_graph.base(),
+                    bsgs_graph.strong_generators().with_inverses()},
+                   ~to_graph),
+    num_processors());
+
+  return PermGroup(bsgs_graph);
+}
+
+void ArchGraph::clear_automorphisms_nauty_cache()
+{
+  std::lock_guard<std::mutex> lock(_canonical_cache_mtx);
+
+  _canonical_cache.clear();
+  _canonical_cache_hits = 0ul;
+}
+
+unsigned long ArchGraph::automorphisms_nauty_cache_hits()
+{
+  std::lock_guard<std::mutex> lock(_canonical_cache_mtx);
 
-  return PermGroup(BSGS(num_processors(), generators, options, aborted));
+  return _canonical_cache_hits;
 }
 
 } // namespace mpsym
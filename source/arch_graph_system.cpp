@@ -1,14 +1,23 @@
 #include <algorithm>
 #include <atomic>
+#include <climits>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iomanip>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <new>
 #include <numeric>
 #include <queue>
 #include <random>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -20,11 +29,16 @@
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
 #include "bsgs.hpp"
+#include "dbg.hpp"
+#include "orbit.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
+#include "perm_matrix.hpp"
 #include "perm_set.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
 #include "task_mapping_orbit.hpp"
+#include "thread_pool.hpp"
 #include "timeout.hpp"
 #include "util.hpp"
 
@@ -35,6 +49,97 @@ namespace mpsym
 
 using namespace internal;
 
+std::string ArchGraphSystem::_automorphisms_cache_dir;
+
+namespace
+{
+
+// shared by all multi start local searches
+SharedThreadPool _local_search_pool;
+
+// shared by all batched representative computations
+SharedThreadPool _repr_batch_pool;
+
+std::string cache_file(std::string const &cache_dir, std::string const &json)
+{
+  std::stringstream ss;
+  ss << cache_dir << "/" << std::hex << std::setw(16)
+     << std::setfill('0') << util::stable_hash(json) << ".bsgs";
+
+  return ss.str();
+}
+
+// representatives depend on the offset, the search method and all options
+// steering it, so mappings are memoized separately for each combination of
+// these, options which only affect local search are ignored otherwise
+uint64_t memo_tag(ReprOptions const &options)
+{
+  bool local_search = options.method == ReprOptions::Method::LOCAL_SEARCH;
+
+  uint64_t T_init_bits = 0u;
+  if (local_search) {
+    std::memcpy(&T_init_bits,
+                &options.local_search_sa_T_init,
+                sizeof(options.local_search_sa_T_init));
+  }
+
+  uint64_t const fields[] = {
+    options.offset,
+    static_cast<uint64_t>(options.method),
+    options.match,
+    options.optimize_symmetric,
+    local_search ? static_cast<uint64_t>(options.variant) : 0u,
+    local_search ? options.local_search_append_generators : 0u,
+    local_search ? options.local_search_sa_iterations : 0u,
+    T_init_bits,
+    local_search ? options.local_search_multi_start_climbers : 0u
+  };
+
+  // FNV-1a over whole fields
+  uint64_t tag = 0xcbf29ce484222325ULL;
+
+  for (uint64_t field : fields) {
+    tag ^= field;
+    tag *= 0x100000001b3ULL;
+  }
+
+  return tag;
+}
+
+} // anonymous namespace
+
+std::string ArchGraphSystem::automorphisms_cache_file() const
+{ return cache_file(_automorphisms_cache_dir, to_json()); }
+
+PermGroup ArchGraphSystem::automorphisms_cached(
+  AutomorphismOptions const *options,
+  timeout::flag aborted)
+{
+  if (_automorphisms_cache_dir.empty())
+    return automorphisms_(options, aborted);
+
+  // the file name is only a hash of the JSON representation, the full
+  // representation is stored in the file and checked when loading it
+  auto json(to_json());
+  auto file(cache_file(_automorphisms_cache_dir, json));
+
+  try {
+    return PermGroup(BSGS::load(file, json));
+  } catch (std::runtime_error const &) {
+    // not cached yet (or unreadable or colliding), fall through
+  }
+
+  auto automorphisms(automorphisms_(options, aborted));
+
+  try {
+    automorphisms.bsgs().save(file, json);
+  } catch (std::runtime_error const &e) {
+    DBG(WARN) << "Failed to cache automorphisms: " << e.what();
+  }
+
+  return automorphisms;
+}
+
 std::shared_ptr<ArchGraphSystem> ArchGraphSystem::expand_automorphisms() const
 {
   auto const *ag(dynamic_cast<ArchGraph const *>(this));
@@ -98,6 +203,146 @@ bool ArchGraphSystem::automorphisms_symmetric(ReprOptions const *options)
   return options->optimize_symmetric && _automorphisms_is_symmetric;
 }
 
+void ArchGraphSystem::prepare_repr(ReprOptions const *options_,
+                                   timeout::flag aborted)
+{
+  auto options(ReprOptions::fill_defaults(options_));
+
+  std::lock_guard<std::mutex> lock(*_repr_mtx);
+
+  prepare_repr_(&options, aborted);
+}
+
+void ArchGraphSystem::prepare_repr_(ReprOptions const *options,
+                                    timeout::flag aborted)
+{
+  init_repr(nullptr, aborted);
+  automorphisms(nullptr, aborted);
+
+  if (_automorphisms.is_trivial() || automorphisms_symmetric(options))
+    return;
+
+  if (options->method == ReprOptions::Method::BACKTRACK &&
+      !_automorphisms_backtrack_valid) {
+    min_elem_backtrack_init();
+  }
+
+  if (options->method == ReprOptions::Method::STABILIZER_CHAIN &&
+      !_automorphisms_stabilizer_chain_valid) {
+    min_elem_stabilizer_chain_init();
+  }
+}
+
+void ArchGraphSystem::repr_batch_flat(unsigned const *mappings,
+                                      std::size_t num_mappings,
+                                      std::size_t mapping_size,
+                                      unsigned *representatives,
+                                      TMORs *orbits,
+                                      unsigned *orbit_indices,
+                                      ReprOptions const *options,
+                                      unsigned num_threads,
+                                      timeout::flag aborted)
+{
+  repr_batch_(num_mappings,
+              [&](std::size_t i){
+                unsigned const *mapping = mappings + i * mapping_size;
+                return TaskMapping(
+                  std::vector<unsigned>(mapping, mapping + mapping_size));
+              },
+              [&](std::size_t i, TaskMapping const &representative){
+                std::copy(representative.begin(),
+                          representative.end(),
+                          representatives + i * mapping_size);
+              },
+              orbits, orbit_indices, options, num_threads, aborted);
+}
+
+void ArchGraphSystem::repr_batch(TaskMappingView const &mappings,
+                                 TaskMapping *representatives,
+                                 TMORs *orbits,
+                                 unsigned *orbit_indices,
+                                 ReprOptions const *options,
+                                 unsigned num_threads,
+                                 timeout::flag aborted)
+{
+  repr_batch_(mappings.size(),
+              [&](std::size_t i){ return mappings[i]; },
+              [&](std::size_t i, TaskMapping const &representative){
+                if (representatives)
+                  representatives[i] = representative;
+              },
+              orbits, orbit_indices, options, num_threads, aborted);
+}
+
+void ArchGraphSystem::repr_batch_(
+  std::size_t num_mappings,
+  std::function<TaskMapping(std::size_t)> const &mapping,
+  std::function<void(std::size_t, TaskMapping const &)> const &store,
+  TMORs *orbits,
+  unsigned *orbit_indices,
+  ReprOptions const *options,
+  unsigned num_threads,
+  timeout::flag aborted)
+{
+  if (num_mappings == 0u)
+    return;
+
+  prepare_repr(options, aborted);
+
+  auto repr_single = [&](std::size_t i) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("repr_batch");
+
+    if (orbits) {
+      auto res(repr_memo_(mapping(i), *orbits, options, aborted));
+
+      store(i, std::get<0>(res));
+
+      if (orbit_indices)
+        orbit_indices[i] = std::get<2>(res);
+
+    } else {
+      store(i, repr_(mapping(i), options, nullptr, aborted));
+    }
+  };
+
+  // concurrent batches (e.g. from several Python threads) fall back to a
+  // temporary pool while the shared one is in use
+  auto lease(_repr_batch_pool.lease(num_threads));
+
+  if (lease) {
+    lease.parallel_for(num_mappings, repr_single);
+  } else {
+    ThreadPool pool(num_threads);
+    pool.parallel_for(num_mappings, repr_single);
+  }
+}
+
+std::tuple<TaskMapping, bool, unsigned> ArchGraphSystem::repr_memo_(
+  TaskMapping const &mapping,
+  TMORs &orbits,
+  ReprOptions const *options,
+  timeout::flag aborted)
+{
+  auto memo(orbits.memo());
+  auto tag(memo_tag(ReprOptions::fill_defaults(options)));
+
+  TaskMapping representative;
+  unsigned orbit_index;
+
+  if (memo && memo->lookup(mapping, tag, representative, orbit_index))
+    return std::make_tuple(representative, false, orbit_index);
+
+  representative = repr_(mapping, options, &orbits, aborted);
+
+  auto ins(orbits.insert(representative));
+
+  if (memo)
+    memo->insert(mapping, tag, representative, ins.second);
+
+  return std::make_tuple(representative, ins.first, ins.second);
+}
+
 TaskMapping ArchGraphSystem::repr_(TaskMapping const &mapping,
                                    ReprOptions const *options_,
                                    TMORs *orbits,
@@ -119,8 +364,14 @@ TaskMapping ArchGraphSystem::repr_(TaskMapping const &mapping,
            min_elem_orbits(mapping, &options, orbits, aborted) :
          options.method == ReprOptions::Method::LOCAL_SEARCH ?
            options.variant == ReprOptions::Variant::LOCAL_SEARCH_SA_LINEAR ?
-             min_elem_local_search_sa(mapping, &options) :
-             min_elem_local_search(mapping, &options) :
+             min_elem_local_search_sa(mapping, &options, aborted) :
+           options.variant == ReprOptions::Variant::LOCAL_SEARCH_MULTI_START ?
+             min_elem_local_search_multi_start(mapping, &options, orbits, aborted) :
+             min_elem_local_search(mapping, &options, aborted) :
+         options.method == ReprOptions::Method::BACKTRACK ?
+           min_elem_backtrack(mapping, &options, aborted) :
+         options.method == ReprOptions::Method::STABILIZER_CHAIN ?
+           min_elem_stabilizer_chain(mapping, &options, aborted) :
          throw std::logic_error("unreachable");
 }
 
@@ -131,18 +382,57 @@ TaskMapping ArchGraphSystem::min_elem_iterate(TaskMapping const &tasks,
 {
   TaskMapping representative(tasks);
 
-  for (auto it = _automorphisms.begin(); it != _automorphisms.end(); ++it) {
+  if (is_repr(representative, options, orbits))
+    return representative;
+
+  auto const &bsgs(_automorphisms.bsgs());
+
+  if (bsgs.base_empty())
+    return representative;
+
+  // group elements are enumerated in the same order as by
+  // PermGroup::const_iterator, i.e. as products u_k * ... * u_1 * u_0 of
+  // transversal elements (where u_k is applied first) with u_0 changing
+  // fastest, images[i] caches tasks permuted by u_k, ..., u_i such that
+  // advancing to the next element only reapplies the factors that changed
+  unsigned base_size = bsgs.base_size();
+
+  std::vector<PermSet> transversals;
+  for (unsigned i = 0u; i < base_size; ++i)
+    transversals.push_back(bsgs.transversals(i));
+
+  std::vector<unsigned> state(base_size, 0u);
+
+  std::vector<TaskMapping> images(base_size + 1u, tasks);
+
+  auto update_images = [&](unsigned level){
+    for (unsigned i = level + 1u; i-- > 0u;) {
+      images[i] = images[i + 1u];
+      images[i].permute(transversals[i][state[i]], options->offset);
+    }
+  };
+
+  update_images(base_size - 1u);
+
+  for (;;) {
     if (timeout::is_set(aborted))
       throw timeout::AbortedError("min_elem_iterate");
 
-    auto const &factors(it.factors());
-
-    if (tasks.less_than(representative, factors, options->offset))
-      representative = tasks.permuted(factors, options->offset);
+    if (images[0].less_than(representative)) {
+      representative = images[0];
 
-    if (is_repr(representative, options, orbits)) {
-      return representative;
+      if (is_repr(representative, options, orbits))
+        return representative;
     }
+
+    unsigned level = 0u;
+    while (level < base_size && ++state[level] == transversals[level].size())
+      state[level++] = 0u;
+
+    if (level == base_size)
+      break;
+
+    update_images(level);
   }
 
   return representative;
@@ -187,42 +477,52 @@ TaskMapping ArchGraphSystem::min_elem_orbits(TaskMapping const &tasks,
 
 TaskMapping ArchGraphSystem::min_elem_local_search(
   TaskMapping const &tasks,
-  ReprOptions const *options) const
+  ReprOptions const *options,
+  timeout::flag aborted) const
 {
-  auto generators(local_search_augment_gens(options));
+  // all generators are evaluated at once, see TransposedPermMatrix
+  TransposedPermMatrix generators_augmented;
+
+  if (options->local_search_append_generators > 0u)
+    generators_augmented = TransposedPermMatrix(local_search_augment_gens(options));
+
+  auto const &generators(options->local_search_append_generators > 0u ?
+                           generators_augmented :
+                           _automorphism_generators_matrix);
 
   TaskMapping representative(tasks);
 
-  std::vector<TaskMapping> possible_representatives;
-  possible_representatives.reserve(generators.size());
+  auto num_tasks = static_cast<unsigned>(representative.size());
+
+  std::vector<unsigned> candidates;
 
   for (;;) {
-    bool stationary = true;
-
-    for (Perm const &gen : generators) {
-      if (representative.less_than(representative, gen, options->offset)) {
-        if (options->variant == ReprOptions::Variant::LOCAL_SEARCH_BFS) {
-          possible_representatives.push_back(
-            representative.permuted(gen, options->offset));
-        } else {
-          representative.permute(gen, options->offset);
-        }
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("min_elem_local_search");
 
-        stationary = false;
-      }
-    }
+    if (options->variant == ReprOptions::Variant::LOCAL_SEARCH_BFS) {
+      unsigned c = generators.min_image(representative.data(),
+                                        num_tasks,
+                                        options->offset,
+                                        candidates);
 
-    if (stationary)
-      break;
+      if (c == generators.cols())
+        break;
 
-    if (options->variant == ReprOptions::Variant::LOCAL_SEARCH_BFS) {
-      representative = *std::min_element(possible_representatives.begin(),
-                                         possible_representatives.end(),
-                                         [](TaskMapping const &lhs,
-                                            TaskMapping const &rhs)
-                                         { return lhs.less_than(rhs); });
+      generators.permute(c, representative.data(), num_tasks, options->offset);
+
+    } else {
+      bool stationary = true;
+
+      for (unsigned c = 0u; c < generators.cols(); ++c) {
+        if (generators.less_than(c, representative.data(), num_tasks, options->offset)) {
+          generators.permute(c, representative.data(), num_tasks, options->offset);
+          stationary = false;
+        }
+      }
 
-      possible_representatives.clear();
+      if (stationary)
+        break;
     }
   }
 
@@ -241,14 +541,88 @@ PermSet ArchGraphSystem::local_search_augment_gens(
   return generators;
 }
 
+TaskMapping ArchGraphSystem::min_elem_local_search_multi_start(
+  TaskMapping const &tasks,
+  ReprOptions const *options,
+  TMORs *orbits,
+  timeout::flag aborted) const
+{
+  unsigned num_climbers = std::max(options->local_search_multi_start_climbers, 1u);
+
+  // best representative found by any climber so far
+  TaskMapping representative(tasks);
+  std::mutex representative_mtx;
+
+  // set as soon as some climber encounters a known representative
+  std::atomic<bool> matched(false);
+
+  auto climb = [&](std::size_t i){
+    if (matched)
+      return;
+
+    // the first climber starts at tasks itself
+    TaskMapping current(i == 0u ? tasks :
+      tasks.permuted(_automorphisms.random_element(), options->offset));
+
+    auto num_tasks = static_cast<unsigned>(current.size());
+
+    std::vector<unsigned> candidates;
+
+    for (;;) {
+      if (timeout::is_set(aborted))
+        throw timeout::AbortedError("min_elem_local_search_multi_start");
+
+      if (matched)
+        return;
+
+      if (is_repr(current, options, orbits)) {
+        std::lock_guard<std::mutex> lock(representative_mtx);
+
+        if (!matched) {
+          representative = current;
+          matched = true;
+        }
+
+        return;
+      }
+
+      unsigned c = _automorphism_generators_matrix.min_image(current.data(),
+                                                             num_tasks,
+                                                             options->offset,
+                                                             candidates);
+
+      if (c == _automorphism_generators_matrix.cols())
+        break;
+
+      _automorphism_generators_matrix.permute(c,
+                                              current.data(),
+                                              num_tasks,
+                                              options->offset);
+    }
+
+    std::lock_guard<std::mutex> lock(representative_mtx);
+
+    if (!matched && current.less_than(representative))
+      representative = current;
+  };
+
+  // climbers are run sequentially if the pool is in use, e.g. because
+  // repr_batch processes several mappings concurrently
+  _local_search_pool.lease(options->local_search_multi_start_num_threads)
+                    .parallel_for(num_climbers, climb);
+
+  return representative;
+}
+
 TaskMapping ArchGraphSystem::min_elem_local_search_sa(
   TaskMapping const &tasks,
-  ReprOptions const *options) const
+  ReprOptions const *options,
+  timeout::flag aborted) const
 {
   using namespace std::placeholders;
 
   // probability distributions
-  static auto re(util::random_engine());
+  static thread_local auto re(util::random_engine());
 
   std::uniform_real_distribution<> d_prob(0.0, 1.0);
 
@@ -265,6 +639,9 @@ TaskMapping ArchGraphSystem::min_elem_local_search_sa(
   std::iota(gen_indices.begin(), gen_indices.end(), 0u);
 
   for (unsigned i = 0u; i < options->local_search_sa_iterations; ++i) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("min_elem_local_search_sa");
+
     // schedule T
     double T = local_search_sa_schedule_T(i, options);
 
@@ -367,4 +744,246 @@ TaskMapping ArchGraphSystem::min_elem_symmetric(
   return representative;
 }
 
+TaskMapping ArchGraphSystem::min_elem_backtrack(TaskMapping const &tasks,
+                                                ReprOptions const *options,
+                                                timeout::flag aborted)
+{
+  if (!_automorphisms_backtrack_valid)
+    min_elem_backtrack_init();
+
+  // a good initial candidate allows pruning most of the search tree early on
+  TaskMapping representative(min_elem_local_search(tasks, options, aborted));
+
+  if (!_automorphisms_backtrack_transversals.empty()) {
+    min_elem_backtrack_search(tasks,
+                              options,
+                              0u,
+                              Perm(_automorphisms.degree()),
+                              representative,
+                              aborted);
+  }
+
+  return representative;
+}
+
+void ArchGraphSystem::min_elem_backtrack_init()
+{
+  auto const &bsgs(_automorphisms.bsgs());
+
+  _automorphisms_backtrack_transversals.clear();
+  _automorphisms_backtrack_orbits.clear();
+
+  for (unsigned i = 0u; i < bsgs.base_size(); ++i) {
+    auto transversals(bsgs.transversals(i));
+
+    _automorphisms_backtrack_transversals.emplace_back(transversals.begin(),
+                                                       transversals.end());
+
+    _automorphisms_backtrack_orbits.emplace_back(
+      bsgs.degree(), bsgs.strong_generators(i + 1u));
+  }
+
+  _automorphisms_backtrack_valid = true;
+}
+
+TaskMapping ArchGraphSystem::min_elem_stabilizer_chain(
+  TaskMapping const &tasks,
+  ReprOptions const *options,
+  timeout::flag aborted)
+{
+  if (!_automorphisms_stabilizer_chain_valid)
+    min_elem_stabilizer_chain_init();
+
+  auto const &moved(_automorphisms_stabilizer_chain_moved);
+
+  unsigned degree = _automorphisms_stabilizer_chain.degree();
+
+  auto in_range = [&](unsigned task){
+    return task >= options->offset && task < degree + options->offset;
+  };
+
+  // the base is changed to the distinct (non-fixed) processors in the order
+  // in which they first appear in tasks, repeated processors and processors
+  // fixed by all automorphisms do not constrain the search any further
+  std::vector<unsigned> prefix;
+  std::vector<bool> in_prefix(degree, false);
+
+  for (unsigned task : tasks) {
+    if (!in_range(task))
+      continue;
+
+    unsigned x = task - options->offset;
+
+    if (moved[x] && !in_prefix[x]) {
+      prefix.push_back(x);
+      in_prefix[x] = true;
+    }
+  }
+
+  if (prefix.empty())
+    return tasks;
+
+  auto bsgs(_automorphisms_stabilizer_chain.unshared());
+
+  bsgs.base_change(prefix);
+
+  // every automorphism is a product h * u_k * ... * u_1 * u_0 of transversal
+  // elements u_i (mapping prefix[i] to some element of the i-th fundamental
+  // orbit) and h in the pointwise stabilizer of the prefix, h fixes all
+  // tasks, so the image of prefix[i] is suffix[u_i[prefix[i]]] where suffix is
+  // u_(i - 1) * ... * u_0, since suffix is a bijection there is exactly one
+  // choice of u_i which minimizes this image and the lexicographically
+  // smallest image can be determined greedily, one orbit scan per level
+  Perm suffix(degree);
+
+  for (unsigned i = 0u; i < prefix.size(); ++i) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("min_elem_stabilizer_chain");
+
+    unsigned beta_min = prefix[i];
+
+    for (unsigned beta : bsgs.orbit(i)) {
+      if (suffix[beta] < suffix[beta_min])
+        beta_min = beta;
+    }
+
+    if (beta_min != prefix[i])
+      suffix = bsgs.transversal(i, beta_min) * suffix;
+  }
+
+  TaskMapping representative(tasks);
+
+  for (unsigned &task : representative) {
+    if (in_range(task))
+      task = suffix[task - options->offset] + options->offset;
+  }
+
+  return representative;
+}
+
+void ArchGraphSystem::min_elem_stabilizer_chain_init()
+{
+  auto const &bsgs(_automorphisms.bsgs());
+
+  unsigned degree = bsgs.degree();
+
+  // base changes require schreier trees which the automorphism group's BSGS
+  // is not necessarily built with
+  BSGSOptions bsgs_options;
+  bsgs_options.transversals = BSGSOptions::Transversals::SCHREIER_TREES;
+
+  _automorphisms_stabilizer_chain = BSGS(degree,
+                                         bsgs.base(),
+                                         bsgs.strong_generators().with_inverses(),
+                                         &bsgs_options);
+
+  _automorphisms_stabilizer_chain_moved.assign(degree, false);
+
+  for (Perm const &gen : bsgs.strong_generators()) {
+    for (unsigned x = 0u; x < degree; ++x) {
+      if (gen[x] != x)
+        _automorphisms_stabilizer_chain_moved[x] = true;
+    }
+  }
+
+  _automorphisms_stabilizer_chain_valid = true;
+}
+
+void ArchGraphSystem::min_elem_backtrack_search(
+  TaskMapping const &tasks,
+  ReprOptions const *options,
+  unsigned level,
+  Perm const &partial,
+  TaskMapping &representative,
+  timeout::flag aborted) const
+{
+  if (timeout::is_set(aborted))
+    throw timeout::AbortedError("min_elem_backtrack");
+
+  // every group element is a product u_k * ... * u_1 * u_0 of transversal
+  // elements where u_i is chosen on level i, partial is u_(level - 1) * ...
+  // * u_0 and all images of tasks under group elements with this suffix are
+  // bounded from below by min_elem_backtrack_bound
+  std::vector<std::pair<TaskMapping, Perm>> children;
+
+  for (Perm const &u : _automorphisms_backtrack_transversals[level]) {
+    Perm child(u * partial);
+
+    bool exact;
+    auto bound(min_elem_backtrack_bound(tasks, options, level, child, exact));
+
+    if (!bound.less_than(representative))
+      continue;
+
+    if (exact)
+      representative = bound;
+    else
+      children.emplace_back(bound, child);
+  }
+
+  // descend into the most promising subtrees first
+  std::sort(children.begin(),
+            children.end(),
+            [](std::pair<TaskMapping, Perm> const &lhs,
+               std::pair<TaskMapping, Perm> const &rhs)
+            { return lhs.first.less_than(rhs.first); });
+
+  for (auto const &child : children) {
+    if (!child.first.less_than(representative))
+      break;
+
+    min_elem_backtrack_search(tasks,
+                              options,
+                              level + 1u,
+                              child.second,
+                              representative,
+                              aborted);
+  }
+}
+
+TaskMapping ArchGraphSystem::min_elem_backtrack_bound(
+  TaskMapping const &tasks,
+  ReprOptions const *options,
+  unsigned level,
+  Perm const &partial,
+  bool &exact) const
+{
+  // the remaining factors lie in the stabilizer below level, so every task
+  // can at best be mapped to the smallest image of its orbit under it
+  auto const &orbits(_automorphisms_backtrack_orbits[level]);
+
+  std::vector<unsigned> orbit_min(orbits.num_partitions(), UINT_MAX);
+
+  for (unsigned x = 0u; x < partial.degree(); ++x) {
+    int i = orbits.partition_index(x);
+
+    if (i != -1)
+      orbit_min[i] = std::min(orbit_min[i], partial[x]);
+  }
+
+  TaskMapping bound(tasks);
+
+  exact = true;
+
+  for (unsigned i = 0u; i < tasks.size(); ++i) {
+    unsigned task = tasks[i];
+
+    if (task < options->offset || task >= partial.degree() + options->offset)
+      continue;
+
+    unsigned x = task - options->offset;
+
+    int j = orbits.partition_index(x);
+
+    if (j == -1 || orbits[j].size() == 1u) {
+      bound[i] = partial[x] + options->offset;
+    } else {
+      bound[i] = orbit_min[j] + options->offset;
+      exact = false;
+    }
+  }
+
+  return bound;
+}
+
 } // namespace mpsym
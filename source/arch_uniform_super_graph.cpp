@@ -1,15 +1,11 @@
 #include <memory>
-#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
 
-#include "arch_graph_automorphisms.hpp"
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
-#include "perm.hpp"
 #include "perm_group.hpp"
-#include "perm_set.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
 
@@ -69,75 +65,6 @@ ArchUniformSuperGraph::num_channels() const
   return inter_channels + intra_channels;
 }
 
-std::shared_ptr<ArchGraphAutomorphisms>
-ArchUniformSuperGraph::wreath_product_action_super_graph(
-  AutomorphismOptions const *options,
-  timeout::flag aborted) const
-{
-  auto automs_super_graph(_subsystem_super_graph->automorphisms());
-
-  unsigned degree_super_graph = _subsystem_super_graph->num_processors();
-  unsigned degree_proto = _subsystem_proto->num_processors();
-  unsigned degree = degree_super_graph * degree_proto;
-
-  PermSet sigma_super_graph_gens;
-
-  for (auto const &gen_ : automs_super_graph.generators()) {
-    std::vector<unsigned> gen(degree);
-
-    for (unsigned i = 0u; i < gen.size(); ++i) {
-      unsigned block_from = i / degree_proto;
-      unsigned block_offs = i % degree_proto;
-
-      gen[i] = gen_[block_from] * degree_proto + block_offs;
-    }
-
-    sigma_super_graph_gens.insert(Perm(gen));
-  }
-
-  PermGroup pg(BSGS(degree, sigma_super_graph_gens, options, aborted));
-
-  return std::make_shared<ArchGraphAutomorphisms>(pg);
-}
-
-std::vector<std::shared_ptr<ArchGraphAutomorphisms>>
-ArchUniformSuperGraph::wreath_product_action_proto(
-  AutomorphismOptions const *options,
-  timeout::flag aborted) const
-{
-  auto automs_proto(_subsystem_proto->automorphisms());
-
-  unsigned degree_super_graph = _subsystem_super_graph->num_processors();
-  unsigned degree_proto = _subsystem_proto->num_processors();
-  unsigned degree = degree_super_graph * degree_proto;
-
-  std::vector<PermSet> sigmas_proto_gens(degree_super_graph);
-
-  for (auto const &gen_ : automs_proto.generators()) {
-    for (unsigned b = 0u; b < sigmas_proto_gens.size(); ++b) {
-      std::vector<unsigned> gen(degree);
-      std::iota(gen.begin(), gen.end(), 0u);
-
-      unsigned block_end = (b + 1u) * degree_proto;
-      unsigned block_start = block_end - degree_proto + 1u;
-
-      for (unsigned j = block_start; j <= block_end; ++j)
-        gen[j - 1u] = gen_[(j - 1u) % degree_proto] + block_start - 1u;
-
-      sigmas_proto_gens[b].insert(Perm(gen));
-    }
-  }
-
-  std::vector<std::shared_ptr<ArchGraphAutomorphisms>> sigmas_proto;
-  for (auto const &gens : sigmas_proto_gens) {
-    PermGroup pg(BSGS(degree, gens, options, aborted));
-
-    sigmas_proto.push_back(std::make_shared<ArchGraphAutomorphisms>(pg));
-  }
-
-  return sigmas_proto;
-}
-
 PermGroup
 ArchUniformSuperGraph::automorphisms_(AutomorphismOptions const *options,
                                       timeout::flag aborted)
@@ -153,56 +80,100 @@ void
 ArchUniformSuperGraph::init_repr_(AutomorphismOptions const *options,
                                   timeout::flag aborted)
 {
-  auto automs_super_graph(
-    _subsystem_super_graph->automorphisms(options, aborted));
-
-  auto automs_proto(
-    _subsystem_proto->automorphisms(options, aborted));
-
-  _super_graph_trivial = automs_super_graph.is_trivial();
-  _proto_trivial = automs_proto.is_trivial();
-
-  if (_super_graph_trivial || _proto_trivial) {
-    _sigma_total = std::make_shared<ArchGraphAutomorphisms>(automorphisms(options, aborted));
-  } else {
-    _sigma_super_graph = wreath_product_action_super_graph(options, aborted);
-    _sigmas_proto = wreath_product_action_proto(options, aborted);
-  }
-
-  _sigmas_valid = true;
+  _subsystem_super_graph->init_repr(options, aborted);
+  _subsystem_proto->init_repr(options, aborted);
 }
 
 bool
 ArchUniformSuperGraph::repr_ready_() const
 {
-  return _subsystem_super_graph->automorphisms_ready() &&
-         _subsystem_proto->automorphisms_ready() &&
-         _sigmas_valid;
+  return _subsystem_super_graph->repr_ready() &&
+         _subsystem_proto->repr_ready();
 }
 
 void
 ArchUniformSuperGraph::reset_repr_()
 {
-  _subsystem_super_graph->reset_automorphisms();
-  _subsystem_proto->reset_automorphisms();
-  _sigmas_valid = false;
+  _subsystem_super_graph->reset_repr();
+  _subsystem_proto->reset_repr();
+}
+
+void
+ArchUniformSuperGraph::prepare_repr_(ReprOptions const *options,
+                                     timeout::flag aborted)
+{
+  _subsystem_super_graph->prepare_repr(options, aborted);
+  _subsystem_proto->prepare_repr(options, aborted);
 }
 
 TaskMapping
 ArchUniformSuperGraph::repr_(TaskMapping const &mapping,
-                             ReprOptions const *options,
-                             TMORs *,
+                             ReprOptions const *options_,
+                             TMORs *orbits,
                              timeout::flag aborted)
 {
+  // representatives are exact (given exact subsystem representatives), so
+  // known representatives are their own representatives
+  if (orbits && orbits->is_repr(mapping))
+    return mapping;
+
+  auto options(ReprOptions::fill_defaults(options_));
+
+  unsigned degree_super_graph = _subsystem_super_graph->num_processors();
+  unsigned degree_proto = _subsystem_proto->num_processors();
+
+  unsigned offset = options.offset;
+  unsigned offset_end = offset + degree_super_graph * degree_proto;
+
+  /* every automorphism maps processor b * p + o (block b, offset o) to
+   * s(b) * p + h_b(o) for some s from the super graph automorphisms and
+   * arbitrary h_b from the proto automorphisms, the lexicographically
+   * smallest image is thus obtained by independently minimizing the offsets
+   * of the tasks in every block under the proto automorphisms and the blocks
+   * of all tasks under the super graph automorphisms */
+  std::vector<unsigned> positions;
+  TaskMapping blocks;
+  std::vector<TaskMapping> block_offsets(degree_super_graph);
+
+  for (auto i = 0u; i < mapping.size(); ++i) {
+    unsigned task = mapping[i];
+
+    if (task < offset || task >= offset_end)
+      continue;
+
+    unsigned block = (task - offset) / degree_proto;
+
+    positions.push_back(i);
+    blocks.push_back(block);
+    block_offsets[block].push_back((task - offset) % degree_proto);
+  }
+
+  if (positions.empty())
+    return mapping;
+
+  auto suboptions(options);
+  suboptions.offset = 0u;
+
+  for (auto &offsets : block_offsets) {
+    if (!offsets.empty())
+      offsets = _subsystem_proto->repr(offsets, &suboptions, aborted);
+  }
+
+  auto blocks_repr(_subsystem_super_graph->repr(blocks, &suboptions, aborted));
+
   TaskMapping representative(mapping);
 
-  if (_super_graph_trivial || _proto_trivial)
-    return _sigma_total->repr(representative, options, aborted);
+  std::vector<unsigned> block_next(degree_super_graph, 0u);
+
+  for (auto i = 0u; i < positions.size(); ++i) {
+    unsigned block = blocks[i];
 
-  for (auto &sigma : _sigmas_proto)
-    representative = sigma->repr(representative, options, aborted);
+    representative[positions[i]] = offset +
+                                   blocks_repr[i] * degree_proto +
+                                   block_offsets[block][block_next[block]++];
+  }
 
-  return _sigma_super_graph->repr(representative, options, aborted);
+  return representative;
 }
 
 } // namespace mpsym
@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "bsgs.hpp"
+#include "cached_transversals.hpp"
 #include "dbg.hpp"
 #include "dump.hpp"
 #include "orbit.hpp"
@@ -20,6 +21,7 @@
 #include "explicit_transversals.hpp"
 #include "schreier_structure.hpp"
 #include "schreier_tree.hpp"
+#include "shallow_schreier_tree.hpp"
 
 namespace mpsym
 {
@@ -27,6 +29,11 @@ namespace mpsym
 namespace internal
 {
 
+std::shared_ptr<SchreierStructure>
+BSGSCachedTransversals::make_schreier_structure(
+  unsigned root, unsigned degree, PermSet const &generators)
+{ return std::make_shared<CachedTransversals>(degree, root, generators, _cache); }
+
 void BSGSTransversalsBase::reserve_schreier_structure(
   unsigned i, unsigned root, unsigned degree)
 {
@@ -45,8 +52,10 @@ void BSGSTransversalsBase::update_schreier_structure(
 
   Orbit::generate(root, generators, ss);
 
-  if (i < _schreier_structures.size())
+  if (i < _schreier_structures.size()) {
     _schreier_structures[i].swap(ss);
+    return;
+  }
 
   assert(i == _schreier_structures.size());
 
@@ -182,29 +191,97 @@ PermSet BSGS::transversals(unsigned i) const
   return transversals;
 }
 
+std::shared_ptr<TransversalCache> BSGS::transversals_cache() const
+{
+  auto cached_transversals(
+    std::dynamic_pointer_cast<BSGSCachedTransversals>(_transversals));
+
+  return cached_transversals ? cached_transversals->cache() : nullptr;
+}
+
 PermSet BSGS::stabilizers(unsigned i) const
 { return schreier_structure(i)->labels(); }
 
 std::pair<Perm, unsigned> BSGS::strip(Perm const &perm, unsigned offs) const
 {
-  Perm result(perm);
+  auto &betas(strip_buffers().betas);
+
+  unsigned level = strip_base_images(perm, offs, betas);
+
+  // only the levels the base images passed have to be applied to the residue
+  std::vector<unsigned> residue(perm.vect());
+
+  for (unsigned i = offs; i < level; ++i) {
+    schreier_structure(i)->transversal_apply_inverse(
+      betas[i - offs], residue.data(), residue.data() + residue.size());
+  }
+
+  return std::make_pair(Perm(residue), level + 1u);
+}
+
+bool BSGS::strips_completely(Perm const &perm, unsigned offs) const
+{
+  auto &buffers(strip_buffers());
+
+  if (strip_base_images(perm, offs, buffers.betas) < base_size())
+    return false;
+
+  // the residue now fixes the remaining base points, check the others
+  auto &images(buffers.images);
+
+  images.resize(degree());
+  for (unsigned x = 0u; x < degree(); ++x)
+    images[x] = perm[x];
 
   for (unsigned i = offs; i < base_size(); ++i) {
-    unsigned beta = result[base_point(i)];
+    schreier_structure(i)->transversal_apply_inverse(
+      buffers.betas[i - offs], images.data(), images.data() + images.size());
+  }
+
+  for (unsigned x = 0u; x < degree(); ++x) {
+    if (images[x] != x)
+      return false;
+  }
+
+  return true;
+}
+
+unsigned BSGS::strip_base_images(Perm const &perm,
+                                 unsigned offs,
+                                 std::vector<unsigned> &betas) const
+{
+  // only track the images of the remaining base points under the residue,
+  // elements that do not strip completely usually fail to do so at some level
+  // and are rejected without touching any other points
+  auto &base_images(strip_buffers().base_images);
+
+  base_images.resize(base_size() - offs);
+  for (unsigned i = offs; i < base_size(); ++i)
+    base_images[i - offs] = perm[base_point(i)];
+
+  betas.resize(base_size() - offs);
+
+  for (unsigned i = offs; i < base_size(); ++i) {
+    unsigned beta = base_images[i - offs];
     if (!schreier_structure(i)->contains(beta))
-      return std::make_pair(result, i + 1u);
+      return i;
+
+    schreier_structure(i)->transversal_apply_inverse(
+      beta,
+      base_images.data() + (i - offs + 1u),
+      base_images.data() + base_images.size());
 
-    result *= ~schreier_structure(i)->transversal(beta);
+    betas[i - offs] = beta;
   }
 
-  return std::make_pair(result, base_size() + 1u);
+  return base_size();
 }
 
-bool BSGS::strips_completely(Perm const &perm) const
+BSGS::StripBuffers &BSGS::strip_buffers()
 {
-  auto strip_result(strip(perm));
+  static thread_local StripBuffers buffers;
 
-  return strip_result.first.id() && strip_result.second == base_size() + 1u;
+  return buffers;
 }
 
 void BSGS::extend_base(unsigned bp)
@@ -223,7 +300,17 @@ void BSGS::transversals_init(BSGSOptions const *options)
       _transversals = std::make_shared<BSGSTransversals<SchreierTree>>();
       break;
     case BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES:
-      throw std::logic_error("TODO");
+      _transversals = std::make_shared<BSGSTransversals<ShallowSchreierTree>>();
+      break;
+    case BSGSOptions::Transversals::CACHED:
+      {
+        auto cache(options->transversals_cache);
+        if (!cache)
+          cache = std::make_shared<TransversalCache>(options->transversals_cache_bytes);
+
+        _transversals = std::make_shared<BSGSCachedTransversals>(cache);
+      }
+      break;
   }
 }
 
@@ -270,6 +357,9 @@ void BSGS::construct_unknown(PermSet const &generators,
     case BSGSOptions::Construction::SCHREIER_SIMS_RANDOM:
       schreier_sims_random(generators, options, aborted);
       break;
+    case BSGSOptions::Construction::SCHREIER_SIMS_PARALLEL:
+      schreier_sims(generators, options, aborted);
+      break;
     case BSGSOptions::Construction::SOLVE:
       solve(generators);
       break;
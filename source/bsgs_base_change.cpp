@@ -76,6 +76,16 @@ void BSGS::base_change(std::vector<unsigned> prefix)
   assert(std::equal(prefix.begin(), prefix.end(), _base.begin()));
 }
 
+BSGS BSGS::unshared() const
+{
+  BSGS bsgs(*this);
+
+  if (_transversals)
+    bsgs._transversals = _transversals->clone();
+
+  return bsgs;
+}
+
 void BSGS::swap_base_points(unsigned i)
 {
   DBG(TRACE) << "Swapping base points " << i + 1u << " and " << i + 2u;
@@ -93,7 +103,7 @@ void BSGS::swap_base_points(unsigned i)
 
   update_schreier_structure(i, sgi);
 
-  auto sgi1(strong_generators(i + 1u));
+  auto sgi1(strong_generators(i + 1u).with_inverses());
   auto oi1(orbit(i + 1u));
 
   update_schreier_structure(i + 1u, sgi1);
@@ -117,8 +127,9 @@ void BSGS::swap_base_points(unsigned i)
     if (!schreier_structure(i + 1)->contains(perm[base_point(i + 1u)])) {
       DBG(TRACE) << "Updating strong generators:";
 
-      // extend strong generators
+      // extend strong generators (keeping them closed under inversion)
       sgi1.insert(perm);
+      sgi1.insert(~perm);
       update_schreier_structure(i + 1u, sgi1);
 
       DBG(TRACE) << "S(" << i + 1u << ") = " << stabilizers(i + 1u);
@@ -194,7 +205,7 @@ void BSGS::conjugate(Perm const &conj)
 
   // update schreier structures
   for (unsigned i = 0u; i < base_size(); ++i)
-    update_schreier_structure(i, strong_generators(i));
+    update_schreier_structure(i, strong_generators(i).with_inverses());
 }
 
 } // namespace internal
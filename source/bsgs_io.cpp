@@ -0,0 +1,378 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bsgs.hpp"
+#include "mapped_schreier_tree.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "schreier_structure.hpp"
+#include "schreier_tree.hpp"
+
+// All BSGS files consist of native endian 32-bit words:
+//
+// header:     magic (2 words), version, byte order mark, checksum (of all
+//             following words), degree, base size, number of strong
+//             generators, key length (in bytes)
+// key:        arbitrary bytes identifying the BSGS, zero padded to a multiple
+//             of the word size
+// generators: images of all strong generators
+// base:       all base points
+// levels:     for every base point: number of labels, images of all labels,
+//             images of all inverted labels, schreier tree edges (parent of
+//             every point, NO_EDGE if the point is not part of the
+//             fundamental orbit), schreier tree edge label indices
+
+namespace
+{
+
+constexpr char MAGIC[8] = {'M', 'P', 'S', 'Y', 'M', 'B', 'S', 'G'};
+constexpr uint32_t VERSION = 3u;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+constexpr std::size_t HEADER_SIZE = 9u;
+constexpr std::size_t CHECKSUM_OFFS = 4u;
+
+static_assert(sizeof(unsigned) == sizeof(uint32_t),
+              "mapped permutation images must be 32-bit words");
+
+// FNV-1a over whole words
+uint32_t checksum(uint32_t const *first, uint32_t const *last)
+{
+  uint32_t hash = 2166136261u;
+
+  for (uint32_t const *it = first; it != last; ++it) {
+    hash ^= *it;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+void push_perm(std::vector<uint32_t> &buf, mpsym::internal::Perm const &perm)
+{
+  for (unsigned x = 0u; x < perm.degree(); ++x)
+    buf.push_back(perm[x]);
+}
+
+bool is_perm(uint32_t const *images, unsigned degree)
+{
+  std::vector<bool> seen(degree, false);
+
+  for (unsigned x = 0u; x < degree; ++x) {
+    if (images[x] >= degree || seen[images[x]])
+      return false;
+
+    seen[images[x]] = true;
+  }
+
+  return true;
+}
+
+// every node in the tree must lead back to the root via valid edges
+bool is_schreier_tree(unsigned degree,
+                      unsigned root,
+                      unsigned num_labels,
+                      uint32_t const *edges,
+                      uint32_t const *edge_labels)
+{
+  using mpsym::internal::MappedSchreierTree;
+
+  if (edges[root] != root)
+    return false;
+
+  for (unsigned x = 0u; x < degree; ++x) {
+    if (x == root || edges[x] == MappedSchreierTree::NO_EDGE)
+      continue;
+
+    if (edges[x] >= degree || edge_labels[x] >= num_labels)
+      return false;
+  }
+
+  // paths from all nodes are at most degree - 1 edges long unless they
+  // contain a cycle
+  for (unsigned x = 0u; x < degree; ++x) {
+    if (edges[x] == MappedSchreierTree::NO_EDGE)
+      continue;
+
+    unsigned current = x;
+
+    for (unsigned i = 0u; current != root; ++i) {
+      if (i == degree)
+        return false;
+
+      current = edges[current];
+
+      if (current == MappedSchreierTree::NO_EDGE)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool is_inverse(uint32_t const *images,
+                uint32_t const *inverse_images,
+                unsigned degree)
+{
+  for (unsigned x = 0u; x < degree; ++x) {
+    if (inverse_images[images[x]] != x)
+      return false;
+  }
+
+  return true;
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+void BSGS::save(std::string const &file, std::string const &key) const
+{
+  std::vector<uint32_t> buf(2u);
+  std::memcpy(buf.data(), MAGIC, sizeof(MAGIC));
+
+  buf.push_back(VERSION);
+  buf.push_back(BYTE_ORDER_MARK);
+  buf.push_back(0u);
+  buf.push_back(degree());
+  buf.push_back(base_size());
+  buf.push_back(_strong_generators.size());
+  buf.push_back(key.size());
+
+  std::size_t key_offs = buf.size();
+  buf.resize(key_offs + (key.size() + sizeof(uint32_t) - 1u) / sizeof(uint32_t));
+  std::memcpy(buf.data() + key_offs, key.data(), key.size());
+
+  for (Perm const &gen : _strong_generators)
+    push_perm(buf, gen);
+
+  buf.insert(buf.end(), _base.begin(), _base.end());
+
+  // schreier trees are rebuilt from the stabilizer generators since not all
+  // schreier structures (e.g. explicit transversals) store one
+  for (unsigned i = 0u; i < base_size(); ++i) {
+    PermSet labels(stabilizers(i));
+
+    buf.push_back(labels.size());
+
+    for (Perm const &label : labels)
+      push_perm(buf, label);
+
+    for (Perm const &label : labels)
+      push_perm(buf, ~label);
+
+    std::vector<uint32_t> edges(degree(), MappedSchreierTree::NO_EDGE);
+    std::vector<uint32_t> edge_labels(degree(), MappedSchreierTree::NO_EDGE);
+
+    unsigned root = base_point(i);
+    edges[root] = root;
+
+    std::vector<unsigned> queue {root};
+
+    for (unsigned j = 0u; j < queue.size(); ++j) {
+      unsigned x = queue[j];
+
+      for (unsigned l = 0u; l < labels.size(); ++l) {
+        unsigned y = labels[l][x];
+
+        if (edges[y] == MappedSchreierTree::NO_EDGE) {
+          edges[y] = x;
+          edge_labels[y] = l;
+          queue.push_back(y);
+        }
+      }
+    }
+
+    buf.insert(buf.end(), edges.begin(), edges.end());
+    buf.insert(buf.end(), edge_labels.begin(), edge_labels.end());
+  }
+
+  buf[CHECKSUM_OFFS] = checksum(buf.data() + HEADER_SIZE,
+                                buf.data() + buf.size());
+
+  // write to a temporary file first such that concurrent readers never
+  // observe partially written files
+  std::string file_tmp(file + ".tmp." + std::to_string(getpid()));
+
+  {
+    std::ofstream os(file_tmp, std::ios::binary | std::ios::trunc);
+
+    os.write(reinterpret_cast<char const *>(buf.data()),
+             buf.size() * sizeof(uint32_t));
+
+    if (!os) {
+      os.close();
+      std::remove(file_tmp.c_str());
+      throw std::runtime_error("failed to write " + file_tmp);
+    }
+  }
+
+  if (std::rename(file_tmp.c_str(), file.c_str()) != 0) {
+    std::remove(file_tmp.c_str());
+    throw std::runtime_error("failed to rename " + file_tmp + " to " + file);
+  }
+}
+
+BSGS BSGS::load(std::string const &file, std::string const &key, bool verify)
+{
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw std::runtime_error("failed to open " + file);
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw std::runtime_error("failed to stat " + file);
+  }
+
+  std::size_t size = static_cast<std::size_t>(st.st_size);
+
+  if (size < HEADER_SIZE * sizeof(uint32_t) || size % sizeof(uint32_t) != 0u) {
+    close(fd);
+    throw std::runtime_error("malformed BSGS file " + file);
+  }
+
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("failed to map " + file);
+
+  // unmapped once the BSGS and the last mapped schreier tree are destroyed
+  std::shared_ptr<void const> data(
+    addr, [size](void const *addr) { munmap(const_cast<void *>(addr), size); });
+
+  auto words = static_cast<uint32_t const *>(addr);
+  std::size_t num_words = size / sizeof(uint32_t);
+  std::size_t pos = 0u;
+
+  auto read = [&](std::size_t n){
+    if (pos + n > num_words)
+      throw std::runtime_error("truncated BSGS file " + file);
+
+    uint32_t const *res = words + pos;
+    pos += n;
+
+    return res;
+  };
+
+  auto malformed_unless = [&](bool valid){
+    if (!valid)
+      throw std::runtime_error("malformed BSGS file " + file);
+  };
+
+  // header
+  if (std::memcmp(read(2u), MAGIC, sizeof(MAGIC)) != 0)
+    throw std::runtime_error("not a BSGS file: " + file);
+
+  if (*read(1u) != VERSION)
+    throw std::runtime_error("unsupported BSGS file version: " + file);
+
+  if (*read(1u) != BYTE_ORDER_MARK)
+    throw std::runtime_error("BSGS file has wrong byte order: " + file);
+
+  // the file was valid when it was written, this detects later corruption
+  if (*read(1u) != checksum(words + HEADER_SIZE, words + num_words))
+    throw std::runtime_error("BSGS file checksum mismatch: " + file);
+
+  unsigned degree = *read(1u);
+  unsigned base_size = *read(1u);
+  unsigned num_strong_generators = *read(1u);
+  std::size_t key_size = *read(1u);
+
+  malformed_unless(degree > 0u);
+
+  // key
+  auto key_stored = reinterpret_cast<char const *>(
+    read((key_size + sizeof(uint32_t) - 1u) / sizeof(uint32_t)));
+
+  if (key_size != key.size() ||
+      std::memcmp(key_stored, key.data(), key_size) != 0)
+    throw std::runtime_error("BSGS file key mismatch: " + file);
+
+  BSGS bsgs(degree);
+
+  bsgs._data = data;
+
+  // only used should new schreier structures be constructed later
+  bsgs._transversals = std::make_shared<BSGSTransversals<SchreierTree>>();
+
+  // strong generators, these refer to the mapped images
+  for (unsigned i = 0u; i < num_strong_generators; ++i) {
+    uint32_t const *images = read(degree);
+
+    if (verify)
+      malformed_unless(is_perm(images, degree));
+
+    bsgs._strong_generators.insert(Perm::borrowed(degree, images));
+  }
+
+  // base
+  uint32_t const *base = read(base_size);
+
+  for (unsigned i = 0u; i < base_size; ++i) {
+    malformed_unless(base[i] < degree);
+
+    bsgs._base.push_back(base[i]);
+  }
+
+  // schreier trees
+  for (unsigned i = 0u; i < base_size; ++i) {
+    unsigned num_labels = *read(1u);
+
+    std::size_t labels_size = static_cast<std::size_t>(num_labels) * degree;
+
+    uint32_t const *labels = read(labels_size);
+    uint32_t const *inverse_labels = read(labels_size);
+    uint32_t const *edges = read(degree);
+    uint32_t const *edge_labels = read(degree);
+
+    if (verify) {
+      for (unsigned j = 0u; j < num_labels; ++j) {
+        uint32_t const *label = labels + static_cast<std::size_t>(j) * degree;
+        uint32_t const *inverse_label =
+          inverse_labels + static_cast<std::size_t>(j) * degree;
+
+        malformed_unless(is_perm(label, degree) &&
+                         is_perm(inverse_label, degree) &&
+                         is_inverse(label, inverse_label, degree));
+      }
+
+      malformed_unless(
+        is_schreier_tree(degree, base[i], num_labels, edges, edge_labels));
+    }
+
+    bsgs._transversals->push_schreier_structure(
+      std::make_shared<MappedSchreierTree>(degree,
+                                           base[i],
+                                           num_labels,
+                                           labels,
+                                           inverse_labels,
+                                           edges,
+                                           edge_labels,
+                                           data));
+  }
+
+  malformed_unless(pos == num_words);
+
+  return bsgs;
+}
+
+} // namespace internal
+
+} // namespace mpsym
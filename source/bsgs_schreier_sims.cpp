@@ -1,7 +1,11 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <memory>
+#include <random>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "bsgs.hpp"
@@ -12,8 +16,10 @@
 #include "pr_randomizer.hpp"
 #include "schreier_generator_queue.hpp"
 #include "schreier_structure.hpp"
+#include "thread_pool.hpp"
 #include "timeout.hpp"
 #include "timer.hpp"
+#include "util.hpp"
 
 namespace mpsym
 {
@@ -21,6 +27,25 @@ namespace mpsym
 namespace internal
 {
 
+namespace
+{
+
+std::mt19937 random_stream(int seed, unsigned stream)
+{
+  if (seed < 0)
+    return util::random_engine();
+
+  std::seed_seq seed_seq {static_cast<unsigned>(seed), stream};
+
+  return std::mt19937(seed_seq);
+}
+
+// shared by all parallel and random schreier sims constructions, these may
+// themselves run concurrently (e.g. for all subsystems of a cluster)
+SharedThreadPool _schreier_sims_pool;
+
+} // anonymous namespace
+
 void BSGS::schreier_sims(PermSet const &generators,
                          BSGSOptions const *options,
                          timeout::flag aborted)
@@ -36,13 +61,27 @@ void BSGS::schreier_sims(PermSet const &generators,
 
   schreier_sims_init(generators, strong_generators, fundamental_orbits);
 
+  // schreier generators are stripped concurrently in the parallel variant
+  std::unique_ptr<SharedThreadPool::Lease> thread_pool;
+
+  if (options->construction ==
+      BSGSOptions::Construction::SCHREIER_SIMS_PARALLEL) {
+    thread_pool.reset(new SharedThreadPool::Lease(
+      _schreier_sims_pool.lease(options->schreier_sims_parallel_num_threads)));
+  }
+
   // run algorithm
-  schreier_sims(strong_generators, fundamental_orbits, options, aborted);
+  schreier_sims(strong_generators,
+                fundamental_orbits,
+                thread_pool.get(),
+                options,
+                aborted);
 }
 
 void BSGS::schreier_sims(std::vector<PermSet> &strong_generators,
                          std::vector<Orbit> &fundamental_orbits,
-                         BSGSOptions const *,
+                         SharedThreadPool::Lease const *thread_pool,
+                         BSGSOptions const *options,
                          timeout::flag aborted)
 {
   std::vector<SchreierGeneratorQueue> schreier_generator_queues(base_size());
@@ -61,81 +100,199 @@ top:
                                             fundamental_orbits[i - 1],
                                             schreier_structure(i - 1));
 
-    for (Perm const &schreier_generator : schreier_generator_queues[i - 1]) {
-      if (schreier_generator.id())
-        continue;
+    Perm strip_perm;
+    unsigned strip_level;
 
-      DBG(TRACE) << "Schreier Generator: " << schreier_generator;
+    bool update_strong_generators;
 
-      // strip
-      TIMER_START("strip");
+    if (thread_pool) {
+      update_strong_generators = schreier_sims_sift_parallel(
+        schreier_generator_queues[i - 1],
+        i,
+        std::max(options->schreier_sims_parallel_batch_size, 1u),
+        *thread_pool,
+        strip_perm,
+        strip_level,
+        aborted);
 
-      Perm strip_perm;
-      unsigned strip_level;
+    } else {
+      update_strong_generators = schreier_sims_sift(
+        schreier_generator_queues[i - 1], i, strip_perm, strip_level);
+    }
 
-      std::tie(strip_perm, strip_level) = strip(schreier_generator, i);
+    // check whether to update base and strong generators
+    if (update_strong_generators) {
+      bool do_extend_base = i == base_size();
 
-      DBG(TRACE) << "Strips to: " << strip_perm << ", " << strip_level;
+      if (do_extend_base) {
+        TIMER_START("extend base");
 
-      TIMER_STOP("strip");
+        // extend base
+        unsigned bp = 0u;
+        for (;;) {
+          auto it = std::find(_base.begin(), _base.end(), bp);
 
-      // check whether to update base and strong generators
-      if (strip_level < base_size() - i || !strip_perm.id()) {
-        bool do_extend_base = i == base_size();
+          if (it == _base.end() && strip_perm[bp] != bp)
+            break;
 
-        if (do_extend_base) {
-          TIMER_START("extend base");
+          ++bp;
 
-          // extend base
-          unsigned bp = 0u;
-          for (;;) {
-            auto it = std::find(_base.begin(), _base.end(), bp);
+          assert(bp <= degree());
+        }
 
-            if (it == _base.end() && strip_perm[bp] != bp)
-              break;
+        extend_base(bp);
 
-            ++bp;
+        DBG(TRACE) << "Adjoined new basepoint:";
+        DBG(TRACE) << "B = " << _base;
 
-            assert(bp <= degree());
-          }
+        TIMER_STOP("extend base");
+      }
 
-          extend_base(bp);
+      // update strong generators and fundamental orbits
+      TIMER_START("update strong gens");
 
-          DBG(TRACE) << "Adjoined new basepoint:";
-          DBG(TRACE) << "B = " << _base;
+      DBG(TRACE) << "Updating strong generators:";
 
-          TIMER_STOP("extend base");
-        }
+      schreier_sims_update_strong_gens(
+        i, {strip_perm}, strong_generators, fundamental_orbits);
 
-        // update strong generators and fundamental orbits
-        TIMER_START("update strong gens");
+      DBG(TRACE) << "S(" << i + 1 << ") = " << strong_generators[i];
+      DBG(TRACE) << "O(" << i + 1 << ") = " << fundamental_orbits[i];
 
-        DBG(TRACE) << "Updating strong generators:";
+      TIMER_STOP("update strong gens");
+
+      // update schreier generator queue
+      if (do_extend_base)
+        schreier_generator_queues.emplace_back();
+      else
+        schreier_generator_queues[i].invalidate();
+
+      ++i;
+
+      goto top;
+    }
+
+    --i;
+  }
+
+  schreier_sims_finish();
+}
+
+bool BSGS::schreier_sims_sift(SchreierGeneratorQueue &schreier_generator_queue,
+                              unsigned i,
+                              Perm &strip_perm,
+                              unsigned &strip_level) const
+{
+  for (Perm const &schreier_generator : schreier_generator_queue) {
+    if (schreier_generator.id())
+      continue;
+
+    DBG(TRACE) << "Schreier Generator: " << schreier_generator;
+
+    // strip
+    TIMER_START("strip");
+
+    std::tie(strip_perm, strip_level) = strip(schreier_generator, i);
+
+    DBG(TRACE) << "Strips to: " << strip_perm << ", " << strip_level;
+
+    TIMER_STOP("strip");
+
+    if (strip_level < base_size() - i || !strip_perm.id())
+      return true;
+  }
+
+  return false;
+}
+
+bool BSGS::schreier_sims_sift_parallel(
+  SchreierGeneratorQueue &schreier_generator_queue,
+  unsigned i,
+  unsigned batch_size,
+  SharedThreadPool::Lease const &thread_pool,
+  Perm &strip_perm,
+  unsigned &strip_level,
+  timeout::flag aborted) const
+{
+  std::vector<Perm> batch;
+  std::vector<SchreierGeneratorQueue::State> batch_states;
+  std::vector<std::pair<Perm, unsigned>> batch_strips;
+
+  batch.reserve(batch_size);
+  batch_states.reserve(batch_size);
 
-        schreier_sims_update_strong_gens(
-          i, {strip_perm}, strong_generators, fundamental_orbits);
+  bool exhausted = false;
 
-        DBG(TRACE) << "S(" << i + 1 << ") = " << strong_generators[i];
-        DBG(TRACE) << "O(" << i + 1 << ") = " << fundamental_orbits[i];
+  while (!exhausted) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("schreier_sims");
 
-        TIMER_STOP("update strong gens");
+    // collect a batch of schreier generators
+    batch.clear();
+    batch_states.clear();
 
-        // update schreier generator queue
-        if (do_extend_base)
-          schreier_generator_queues.emplace_back();
-        else
-          schreier_generator_queues[i].invalidate();
+    exhausted = true;
+
+    for (Perm const &schreier_generator : schreier_generator_queue) {
+      if (schreier_generator.id())
+        continue;
 
-        ++i;
+      batch.push_back(schreier_generator);
+      batch_states.push_back(schreier_generator_queue.state());
 
-        goto top;
+      if (batch.size() == batch_size) {
+        exhausted = false;
+        break;
       }
     }
 
-    --i;
+    if (batch.empty())
+      break;
+
+    DBG(TRACE) << "Stripping " << batch.size() << " Schreier Generators";
+
+    // strip all of them concurrently, generators after the first one not
+    // stripping completely need not be stripped since the serial algorithm
+    // would never have reached them
+    TIMER_START("strip");
+
+    batch_strips.resize(batch.size());
+
+    std::atomic<std::size_t> first_residue(batch.size());
+
+    thread_pool.parallel_for(batch.size(), [&](std::size_t j){
+      if (j > first_residue)
+        return;
+
+      batch_strips[j] = strip(batch[j], i);
+
+      if (batch_strips[j].second < base_size() - i ||
+          !batch_strips[j].first.id()) {
+
+        std::size_t current = first_residue;
+        while (j < current && !first_residue.compare_exchange_weak(current, j))
+          ;
+      }
+    });
+
+    TIMER_STOP("strip");
+
+    // commit only the first residue and rewind the queue to its generator
+    if (first_residue < batch.size()) {
+      std::size_t j = first_residue;
+
+      schreier_generator_queue.restore(batch_states[j]);
+
+      std::tie(strip_perm, strip_level) = batch_strips[j];
+
+      DBG(TRACE) << "Schreier Generator: " << batch[j];
+      DBG(TRACE) << "Strips to: " << strip_perm << ", " << strip_level;
+
+      return true;
+    }
   }
 
-  schreier_sims_finish();
+  return false;
 }
 
 void BSGS::schreier_sims_random(PermSet const &generators,
@@ -149,14 +306,40 @@ void BSGS::schreier_sims_random(PermSet const &generators,
   std::vector<PermSet> strong_generators;
   std::vector<Orbit> fundamental_orbits;
 
-  if (!options->schreier_sims_random_guarantee) {
+  // random element streams, these are kept across retries
+  unsigned num_threads = options->schreier_sims_random_num_threads;
+  if (num_threads == 0u)
+    num_threads = ThreadPool::default_num_threads();
+
+  std::vector<PrRandomizer> randomizers;
+  for (unsigned i = 0u; i < num_threads; ++i) {
+    randomizers.emplace_back(
+      generators, random_stream(options->schreier_sims_random_seed, i));
+  }
+
+  std::unique_ptr<SharedThreadPool::Lease> thread_pool;
+  if (num_threads > 1u) {
+    thread_pool.reset(new SharedThreadPool::Lease(
+      _schreier_sims_pool.lease(num_threads)));
+  }
+
+  auto run = [&]{
     schreier_sims_init(generators, strong_generators, fundamental_orbits);
-    schreier_sims_random(strong_generators, fundamental_orbits, options, aborted);
+
+    schreier_sims_random(strong_generators,
+                         fundamental_orbits,
+                         randomizers,
+                         thread_pool.get(),
+                         options,
+                         aborted);
+  };
+
+  if (!options->schreier_sims_random_guarantee) {
+    run();
 
   } else {
     auto try_bsgs = [&](bool check_order){
-      schreier_sims_init(generators, strong_generators, fundamental_orbits);
-      schreier_sims_random(strong_generators, fundamental_orbits, options, aborted);
+      run();
 
       // we assume that if the BSGS is correct if it has the correct order
       if (check_order)
@@ -185,10 +368,17 @@ void BSGS::schreier_sims_random(PermSet const &generators,
       try_bsgs(false);
     }
 
-    // force correctness by running the deterministic Schreier Sims algorithm
+    // force correctness by running the deterministic Schreier Sims algorithm,
+    // Schreier generators are then stripped in batches (on the same threads)
+    // if several threads were used to generate random elements
     if (!correct) {
       DBG(TRACE) << "Executing Schreier Sims algorithm to guarantee correctness";
-      schreier_sims(strong_generators, fundamental_orbits, options, aborted);
+
+      schreier_sims(strong_generators,
+                    fundamental_orbits,
+                    thread_pool.get(),
+                    options,
+                    aborted);
     }
   }
 
@@ -197,67 +387,78 @@ void BSGS::schreier_sims_random(PermSet const &generators,
 
 void BSGS::schreier_sims_random(std::vector<PermSet> &strong_generators,
                                 std::vector<Orbit> &fundamental_orbits,
+                                std::vector<PrRandomizer> &randomizers,
+                                SharedThreadPool::Lease const *thread_pool,
                                 BSGSOptions const *options,
                                 timeout::flag aborted)
 {
-  // random group element generator
-  PrRandomizer pr(_strong_generators);
+  // one random element per stream is generated and stripped concurrently,
+  // the residues are then processed in stream order, once one of them
+  // changes the BSGS the remaining ones are stale and discarded
+  std::vector<std::pair<Perm, unsigned>> batch_strips(randomizers.size());
+
+  auto strip_random = [&](std::size_t j){
+    batch_strips[j] = strip(randomizers[j].next());
+  };
 
   unsigned c = 0u;
   while (c < options->schreier_sims_random_w) {
     if (timeout::is_set(aborted))
       throw timeout::AbortedError("schreier_sims_random");
 
-    // generate random group element
-    Perm rand_perm = pr.next();
-    DBG(TRACE) << "Random group element: " << rand_perm;
+    // generate and strip random group elements
+    if (thread_pool)
+      thread_pool->parallel_for(randomizers.size(), strip_random);
+    else
+      strip_random(0u);
 
-    // strip
-    Perm strip_perm;
-    unsigned strip_level;
-
-    std::tie(strip_perm, strip_level) = strip(rand_perm);
+    for (auto const &batch_strip : batch_strips) {
+      Perm strip_perm(batch_strip.first);
+      unsigned strip_level = batch_strip.second;
 
-    DBG(TRACE) << "Strips to: " << strip_perm << ", " << strip_level;
+      DBG(TRACE) << "Strips to: " << strip_perm << ", " << strip_level;
 
-    // check whether to update base and strong generators
-    bool update_strong_generators = false;
+      // check whether to update base and strong generators
+      bool update_strong_generators = false;
 
-    if (strip_level <= base_size()) {
-      update_strong_generators = true;
+      if (strip_level <= base_size()) {
+        update_strong_generators = true;
 
-    } else if (!strip_perm.id()) {
-      update_strong_generators = true;
+      } else if (!strip_perm.id()) {
+        update_strong_generators = true;
 
-      // extend base
-      for (unsigned bp = 0u; bp < degree(); ++bp) {
-        if (strip_perm[bp] != bp) {
-          extend_base(bp);
+        // extend base
+        for (unsigned bp = 0u; bp < degree(); ++bp) {
+          if (strip_perm[bp] != bp) {
+            extend_base(bp);
 
-          DBG(TRACE) << "Adjoined new basepoint:";
-          DBG(TRACE) << "B = " << _base;
+            DBG(TRACE) << "Adjoined new basepoint:";
+            DBG(TRACE) << "B = " << _base;
 
-          break;
+            break;
+          }
         }
       }
-    }
 
-    if (update_strong_generators) {
-      DBG(TRACE) << "Updating strong generators:";
+      if (update_strong_generators) {
+        DBG(TRACE) << "Updating strong generators:";
 
-      // update strong generators
-      for (unsigned i = 1u; i < strip_level; ++i) {
-        schreier_sims_update_strong_gens(
-          i, {strip_perm}, strong_generators, fundamental_orbits);
+        // update strong generators
+        for (unsigned i = 1u; i < strip_level; ++i) {
+          schreier_sims_update_strong_gens(
+            i, {strip_perm}, strong_generators, fundamental_orbits);
 
-        DBG(TRACE) << "S(" << (i + 1u) << ") = " << strong_generators[i];
-        DBG(TRACE) << "O(" << (i + 1u) << ") = " << fundamental_orbits[i];
-      }
+          DBG(TRACE) << "S(" << (i + 1u) << ") = " << strong_generators[i];
+          DBG(TRACE) << "O(" << (i + 1u) << ") = " << fundamental_orbits[i];
+        }
 
-      c = 0u;
+        c = 0u;
 
-    } else {
-      ++c;
+        break;
+      }
+
+      if (++c == options->schreier_sims_random_w)
+        break;
     }
   }
 }
@@ -0,0 +1,169 @@
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "cached_transversals.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+
+namespace
+{
+
+std::atomic<unsigned long> next_cached_transversals_id(0u);
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+TransversalCache::TransversalCache(std::size_t max_bytes)
+: _max_bytes(max_bytes),
+  _bytes(0u),
+  _hits(0u),
+  _misses(0u)
+{}
+
+std::size_t TransversalCache::bytes() const
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  return _bytes;
+}
+
+std::size_t TransversalCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  return _entries.size();
+}
+
+bool TransversalCache::find(key_type const &key, Perm &perm)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  auto it(_index.find(key));
+
+  if (it == _index.end()) {
+    ++_misses;
+    return false;
+  }
+
+  ++_hits;
+
+  // mark as most recently used
+  _entries.splice(_entries.begin(), _entries, it->second);
+
+  perm = it->second->second;
+
+  return true;
+}
+
+void TransversalCache::insert(key_type const &key, Perm const &perm)
+{
+  std::size_t bytes = perm_bytes(perm);
+
+  if (bytes > _max_bytes)
+    return;
+
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  // another thread might have inserted the same transversal in the meantime
+  if (_index.find(key) != _index.end())
+    return;
+
+  // evict least recently used transversals
+  while (_bytes + bytes > _max_bytes) {
+    assert(!_entries.empty());
+
+    _bytes -= perm_bytes(_entries.back().second);
+    _index.erase(_entries.back().first);
+    _entries.pop_back();
+  }
+
+  _entries.emplace_front(key, perm);
+  _index[key] = _entries.begin();
+
+  _bytes += bytes;
+}
+
+void TransversalCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  _entries.clear();
+  _index.clear();
+  _bytes = 0u;
+
+  _hits = 0u;
+  _misses = 0u;
+}
+
+std::size_t TransversalCache::perm_bytes(Perm const &perm)
+{
+  std::size_t bytes = sizeof(entry_type);
+
+  if (perm.degree() > Perm::SMALL_DEGREE)
+    bytes += perm.degree() * sizeof(unsigned);
+
+  return bytes;
+}
+
+std::size_t TransversalCache::KeyHash::operator()(key_type const &key) const
+{
+  std::size_t seed = std::hash<unsigned long>()(key.first);
+  seed ^= key.second + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+  return seed;
+}
+
+CachedTransversals::CachedTransversals(unsigned degree,
+                                       unsigned root,
+                                       PermSet const &labels,
+                                       std::shared_ptr<TransversalCache> cache)
+: _degree(degree),
+  _root(root),
+  _tree(degree, root, labels),
+  _cache(cache),
+  _id(next_cached_transversals_id++)
+{ assert(_cache); }
+
+void CachedTransversals::create_edge(unsigned origin,
+                                     unsigned destination,
+                                     unsigned label)
+{
+  // cached transversals that are replaced are never looked up again
+  if (_tree.contains(origin))
+    _id = next_cached_transversals_id++;
+
+  _tree.create_edge(origin, destination, label);
+}
+
+Perm CachedTransversals::transversal(unsigned origin) const
+{
+  if (origin == _root)
+    return Perm(_degree);
+
+  TransversalCache::key_type key(_id, origin);
+
+  Perm result;
+  if (_cache->find(key, result))
+    return result;
+
+  result = _tree.transversal(origin);
+
+  _cache->insert(key, result);
+
+  return result;
+}
+
+} // namespace internal
+
+} // namespace mpsym
@@ -1,3 +1,4 @@
+#include <cassert>
 #include <ostream>
 #include <vector>
 
@@ -57,6 +58,29 @@ Perm ExplicitTransversals::transversal(unsigned origin) const
   return it->second;
 }
 
+void ExplicitTransversals::transversal_apply_inverse(unsigned origin,
+                                                     unsigned *first,
+                                                     unsigned *last) const
+{
+  assert(contains(origin));
+
+  if (origin == _root)
+    return;
+
+  Perm const &transversal(_orbit.find(origin)->second);
+
+  // invert the stored transversal into a buffer reused by the calling thread
+  // instead of copying and inverting it
+  static thread_local std::vector<unsigned> inverse;
+
+  inverse.resize(_degree);
+  for (unsigned x = 0u; x < _degree; ++x)
+    inverse[transversal[x]] = x;
+
+  for (unsigned *it = first; it != last; ++it)
+    *it = inverse[*it];
+}
+
 void ExplicitTransversals::dump(std::ostream &os) const
 {
   os << "explicit transversals:\n";
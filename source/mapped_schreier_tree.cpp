@@ -0,0 +1,192 @@
+#include <cassert>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "mapped_schreier_tree.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "schreier_tree.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+constexpr uint32_t MappedSchreierTree::NO_EDGE;
+
+unsigned MappedSchreierTree::root() const { return _root; }
+
+std::vector<unsigned> MappedSchreierTree::nodes() const
+{
+  if (_tree)
+    return _tree->nodes();
+
+  std::vector<unsigned> result {_root};
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (x != _root && _edges[x] != NO_EDGE)
+      result.push_back(x);
+  }
+
+  return result;
+}
+
+PermSet MappedSchreierTree::labels() const
+{
+  if (_tree)
+    return _tree->labels();
+
+  PermSet result;
+
+  for (unsigned i = 0u; i < _num_labels; ++i)
+    result.insert(Perm(std::vector<unsigned>(label(i), label(i) + _degree)));
+
+  return result;
+}
+
+bool MappedSchreierTree::contains(unsigned node) const
+{
+  if (_tree)
+    return _tree->contains(node);
+
+  return node == _root || _edges[node] != NO_EDGE;
+}
+
+bool MappedSchreierTree::incoming(unsigned node, Perm const &edge) const
+{
+  assert(edge.degree() == _degree);
+
+  if (_tree)
+    return _tree->incoming(node, edge);
+
+  unsigned destination = edge[node];
+
+  if (destination == _root || _edges[destination] == NO_EDGE)
+    return false;
+
+  uint32_t const *l = label(_edge_labels[destination]);
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (l[x] != edge[x])
+      return false;
+  }
+
+  return true;
+}
+
+Perm MappedSchreierTree::transversal(unsigned origin) const
+{
+  assert(contains(origin));
+
+  if (_tree)
+    return _tree->transversal(origin);
+
+  // labels along the path from origin to the root
+  std::vector<uint32_t const *> path;
+
+  unsigned current = origin;
+  while (current != _root) {
+    path.push_back(label(_edge_labels[current]));
+    current = _edges[current];
+  }
+
+  // apply them starting at the root without creating intermediate perms
+  std::vector<unsigned> result(_degree);
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    unsigned y = x;
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+      y = (*it)[y];
+
+    result[x] = y;
+  }
+
+  return Perm(result);
+}
+
+void MappedSchreierTree::transversal_apply_inverse(unsigned origin,
+                                                   unsigned *first,
+                                                   unsigned *last) const
+{
+  assert(contains(origin));
+
+  if (_tree) {
+    _tree->transversal_apply_inverse(origin, first, last);
+    return;
+  }
+
+  // the inverted transversal applies the inverted labels from origin upwards
+  unsigned current = origin;
+  while (current != _root) {
+    uint32_t const *inverse = inverse_label(_edge_labels[current]);
+
+    for (unsigned *it = first; it != last; ++it)
+      *it = inverse[*it];
+
+    current = _edges[current];
+  }
+}
+
+void MappedSchreierTree::dump(std::ostream &os) const
+{
+  if (_tree) {
+    os << *_tree;
+    return;
+  }
+
+  os << "mapped schreier tree: [\n";
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (x == _root || _edges[x] == NO_EDGE)
+      continue;
+
+    os << "  " << x << ": [" << _edges[x] << " "
+       << Perm(std::vector<unsigned>(label(_edge_labels[x]),
+                                     label(_edge_labels[x]) + _degree))
+       << "]\n";
+  }
+
+  os << "]\n";
+}
+
+SchreierTree *MappedSchreierTree::writable()
+{
+  if (_tree)
+    return _tree.get();
+
+  _tree.reset(new SchreierTree(_degree, _root, labels()));
+
+  // edges must be created from the root outwards
+  std::vector<unsigned> path;
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (_edges[x] == NO_EDGE)
+      continue;
+
+    unsigned current = x;
+    while (!_tree->contains(current)) {
+      path.push_back(current);
+      current = _edges[current];
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+      _tree->create_edge(*it, _edges[*it], _edge_labels[*it]);
+
+    path.clear();
+  }
+
+  // the mapped arrays are no longer needed
+  _labels = nullptr;
+  _inverse_labels = nullptr;
+  _edges = nullptr;
+  _edge_labels = nullptr;
+  _data.reset();
+
+  return _tree.get();
+}
+
+} // namespace internal
+
+} // namespace mpsym
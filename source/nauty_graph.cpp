@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 extern "C" {
@@ -146,9 +148,28 @@ void NautyGraph::set_partition(std::vector<std::vector<int>> const &ptn)
 }
 
 PermSet NautyGraph::automorphism_generators()
+{ return automorphism_generators(false); }
+
+PermSet NautyGraph::automorphism_generators(std::vector<int> &canonical_labeling,
+                                            std::string &canonical_graph)
 {
-  if (_edges.empty())
+  auto gens(automorphism_generators(true));
+
+  canonical_labeling.assign(_lab, _lab + _n);
+  canonical_graph = this->canonical_graph();
+
+  return gens;
+}
+
+PermSet NautyGraph::automorphism_generators(bool canonical)
+{
+  if (_edges.empty()) {
+    // any labeling that respects the partition is canonical
+    if (canonical && _ptn_expl.empty())
+      std::iota(_lab, _lab + _n, 0);
+
     return {};
+  }
 
   // construct (sparse) nauty graph
   sparsegraph sg;
@@ -184,22 +205,35 @@ PermSet NautyGraph::automorphism_generators()
       sg.e[e_offs++] = target;
   }
 
-  // set nauty options
+  // set nauty options, the defaults are shared by all graphs and must not be
+  // modified in place
   static DEFAULTOPTIONS_SPARSEDIGRAPH(nauty_options_directed);
   static DEFAULTOPTIONS_SPARSEGRAPH(nauty_options_undirected);
 
-  auto &nauty_options = _directed ? nauty_options_directed
-                                  : nauty_options_undirected;
+  optionblk nauty_options = _directed ? nauty_options_directed
+                                      : nauty_options_undirected;
 
   nauty_options.defaultptn = _ptn_expl.empty() ? TRUE : FALSE;
   nauty_options.userautomproc = _save_gens;
+  nauty_options.getcanon = canonical ? TRUE : FALSE;
 
   // call nauty
   _gens.clear();
   _gen_degree = _n_reduced;
 
   statsblk stats;
-  sparsenauty(&sg, _lab, _ptn, _orbits, &nauty_options, &stats, nullptr);
+
+  if (canonical) {
+    // _lab is overwritten with the canonical labeling
+    sparsegraph sg_canon;
+    SG_INIT(sg_canon);
+
+    sparsenauty(&sg, _lab, _ptn, _orbits, &nauty_options, &stats, &sg_canon);
+
+    SG_FREE(sg_canon);
+  } else {
+    sparsenauty(&sg, _lab, _ptn, _orbits, &nauty_options, &stats, nullptr);
+  }
 
   // free memory
   SG_FREE(sg);
@@ -208,6 +242,35 @@ PermSet NautyGraph::automorphism_generators()
   return _gens;
 }
 
+std::string NautyGraph::canonical_graph() const
+{
+  std::vector<int> lab_inv(_n);
+  for (int i = 0; i < _n; ++i)
+    lab_inv[_lab[i]] = i;
+
+  std::vector<std::pair<int, int>> edges_canon;
+  edges_canon.reserve(_edges.size());
+
+  for (auto const &edge : _edges)
+    edges_canon.emplace_back(lab_inv[edge.first], lab_inv[edge.second]);
+
+  std::sort(edges_canon.begin(), edges_canon.end());
+
+  std::stringstream ss;
+
+  ss << (_directed ? "d" : "u") << _n << "," << _n_reduced << ":";
+
+  for (auto const &p : _ptn_expl)
+    ss << p.size() << ",";
+
+  ss << ":";
+
+  for (auto const &edge : edges_canon)
+    ss << edge.first << "-" << edge.second << ",";
+
+  return ss.str();
+}
+
 } // namespace internal
 
 } // namespace mpsym
@@ -1,9 +1,11 @@
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iterator>
 #include <numeric>
 #include <ostream>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "dump.hpp"
@@ -16,32 +18,42 @@ namespace mpsym
 namespace internal
 {
 
+constexpr unsigned Perm::SMALL_DEGREE;
+
 Perm::Perm(unsigned deg)
-: _degree(deg),
-  _perm(deg)
+: _degree(0u)
 {
-  assert(degree() > 0u);
+  assert(deg > 0u);
+
+  resize(deg);
 
-  std::iota(_perm.begin(), _perm.end(), 0u);
+  if (small())
+    std::iota(_perm_small, _perm_small + degree(), 0u);
+  else
+    std::iota(_perm_large, _perm_large + degree(), 0u);
 }
 
 Perm::Perm(std::vector<unsigned> const &perm)
+: _degree(0u)
 {
-  _perm = perm;
-
-  assert(!_perm.empty());
+  assert(!perm.empty());
 
-  _degree = *std::max_element(_perm.begin(), _perm.end()) + 1u;
+  resize(*std::max_element(perm.begin(), perm.end()) + 1u);
 
-  assert(_perm.size() == degree());
+  assert(perm.size() == degree());
 
 #ifndef NDEBUG
-  std::set<unsigned> domain(_perm.begin(), _perm.end());
+  std::set<unsigned> domain(perm.begin(), perm.end());
 
   assert(domain.size() == degree());
   assert(*domain.begin() == 0u);
   assert(*domain.rbegin() == degree() - 1u);
 #endif
+
+  if (small())
+    std::copy(perm.begin(), perm.end(), _perm_small);
+  else
+    std::copy(perm.begin(), perm.end(), _perm_large);
 }
 
 Perm::Perm(unsigned deg, std::vector<std::vector<unsigned>> const &cycles)
@@ -64,10 +76,10 @@ Perm::Perm(unsigned deg, std::vector<std::vector<unsigned>> const &cycles)
 
     for (auto i = 1u; i < cycle.size(); ++i) {
       assert(cycle[i] < degree());
-      _perm[cycle[i - 1u]] = cycle[i];
+      set(cycle[i - 1u], cycle[i]);
     }
 
-    _perm[cycle.back()] = cycle[0];
+    set(cycle.back(), cycle[0]);
 
   } else {
     for (auto i = cycles.begin(); i != cycles.end(); ++i)
@@ -75,20 +87,121 @@ Perm::Perm(unsigned deg, std::vector<std::vector<unsigned>> const &cycles)
   }
 }
 
-unsigned const& Perm::operator[](unsigned i) const
+Perm Perm::borrowed(unsigned deg, unsigned const *images)
+{
+  Perm perm;
+
+  if (deg <= SMALL_DEGREE) {
+    perm.resize(deg);
+    std::copy(images, images + deg, perm._perm_small);
+  } else {
+    // borrowed images are never written to, see own
+    perm._degree = deg;
+    perm._borrowed = true;
+    perm._perm_large = const_cast<unsigned *>(images);
+  }
+
+  return perm;
+}
+
+Perm::Perm(Perm const &other)
+: _degree(0u)
+{ *this = other; }
+
+Perm::Perm(Perm &&other) noexcept
+: _degree(0u)
+{ *this = std::move(other); }
+
+Perm::~Perm()
+{
+  if (!small() && !_borrowed)
+    delete[] _perm_large;
+}
+
+Perm &Perm::operator=(Perm const &rhs)
+{
+  if (this == &rhs)
+    return *this;
+
+  resize(rhs.degree());
+
+  if (small())
+    std::copy(rhs._perm_small, rhs._perm_small + degree(), _perm_small);
+  else
+    std::copy(rhs._perm_large, rhs._perm_large + degree(), _perm_large);
+
+  return *this;
+}
+
+Perm &Perm::operator=(Perm &&rhs) noexcept
 {
-  assert(i < degree());
-  return _perm[i];
+  if (this == &rhs)
+    return *this;
+
+  if (!small() && !_borrowed)
+    delete[] _perm_large;
+
+  _degree = rhs.degree();
+  _borrowed = rhs._borrowed;
+
+  if (rhs.small()) {
+    std::copy(rhs._perm_small, rhs._perm_small + degree(), _perm_small);
+
+  } else {
+    _perm_large = rhs._perm_large;
+
+    // leave rhs as the identity of degree one
+    rhs._degree = 1u;
+    rhs._borrowed = false;
+    rhs._perm_small[0] = 0u;
+  }
+
+  return *this;
+}
+
+void Perm::resize(unsigned deg)
+{
+  // large permutations of the same degree keep their buffer
+  if (deg == _degree && !_borrowed)
+    return;
+
+  if (!small() && !_borrowed)
+    delete[] _perm_large;
+
+  _degree = deg;
+  _borrowed = false;
+
+  if (!small())
+    _perm_large = new unsigned[deg];
+}
+
+void Perm::own()
+{
+  if (!_borrowed)
+    return;
+
+  unsigned const *images = _perm_large;
+
+  _perm_large = new unsigned[degree()];
+  std::copy(images, images + degree(), _perm_large);
+
+  _borrowed = false;
 }
 
 Perm Perm::operator~() const
 {
-  std::vector<unsigned> inverse(degree());
+  Perm inverse;
+  inverse.resize(degree());
 
-  for (unsigned i = 0u; i < degree(); ++i)
-    inverse[(*this)[i]] = i;
+  if (small()) {
+    for (unsigned i = 0u; i < degree(); ++i)
+      inverse._perm_small[_perm_small[i]] = static_cast<uint8_t>(i);
+  } else {
+    for (unsigned i = 0u; i < degree(); ++i)
+      inverse._perm_large[_perm_large[i]] = i;
+  }
 
-  return Perm(inverse);
+  return inverse;
 }
 
 std::ostream &operator<<(std::ostream &os, const Perm &perm)
@@ -107,12 +220,10 @@ bool Perm::operator==(Perm const &rhs) const
 {
   assert(rhs.degree() == degree());
 
-  for (unsigned i = 0u; i < degree(); ++i) {
-    if ((*this)[i] != rhs[i])
-      return false;
-  }
+  if (small())
+    return std::equal(_perm_small, _perm_small + degree(), rhs._perm_small);
 
-  return true;
+  return std::equal(_perm_large, _perm_large + degree(), rhs._perm_large);
 }
 
 bool Perm::operator<(Perm const &rhs) const
@@ -122,18 +233,33 @@ Perm& Perm::operator*=(Perm const &rhs)
 {
   assert(rhs.degree() == degree());
 
-  for (unsigned i = 0u; i < rhs.degree(); ++i)
-    _perm[i] = rhs[(*this)[i]];
+  if (small()) {
+    for (unsigned i = 0u; i < degree(); ++i)
+      _perm_small[i] = rhs._perm_small[_perm_small[i]];
+  } else {
+    own();
+
+    for (unsigned i = 0u; i < degree(); ++i)
+      _perm_large[i] = rhs._perm_large[_perm_large[i]];
+  }
 
   return *this;
 }
 
 bool Perm::id() const
 {
-  for (unsigned i = 0u; i < degree(); ++i) {
-    if ((*this)[i] != i)
-      return false;
+  if (small()) {
+    for (unsigned i = 0u; i < degree(); ++i) {
+      if (_perm_small[i] != i)
+        return false;
+    }
+  } else {
+    for (unsigned i = 0u; i < degree(); ++i) {
+      if (_perm_large[i] != i)
+        return false;
+    }
   }
+
   return true;
 }
 
@@ -155,35 +281,37 @@ std::vector<std::vector<unsigned>> Perm::cycles() const
 
   std::vector<unsigned> cycle;
 
-  std::set<unsigned> done;
+  // small permutations track processed points in a bitmask
+  uint64_t done_small = 0u;
+  std::vector<bool> done(small() ? 0u : degree());
 
-  unsigned first, current;
-  first = current = 0u;
+  auto is_done = [&](unsigned x)
+  { return small() ? (done_small >> x) & 1u : done[x]; };
 
-  for (;;) {
-    done.insert(current);
-    cycle.push_back(current);
+  for (unsigned first = 0u; first < degree(); ++first) {
+    if (is_done(first))
+      continue;
 
-    current = (*this)[current];
+    unsigned current = first;
 
-    if (current == first) {
-      if (cycle.size() > 1u)
-        result.push_back(cycle);
+    do {
+      if (small())
+        done_small |= uint64_t(1u) << current;
+      else
+        done[current] = true;
 
-      cycle.clear();
+      cycle.push_back(current);
 
-      if (done.size() == degree())
-        return result;
+      current = (*this)[current];
+    } while (current != first);
 
-      for (unsigned i = 0u; i < degree(); ++i) {
-        if (done.find(i) == done.end()) {
-          first = i;
-          current = i;
-          break;
-        }
-      }
-    }
+    if (cycle.size() > 1u)
+      result.push_back(cycle);
+
+    cycle.clear();
   }
+
+  return result;
 }
 
 Perm Perm::extended(unsigned deg) const
@@ -239,6 +367,14 @@ namespace std
 
 std::size_t hash<mpsym::internal::Perm>::operator()(
   mpsym::internal::Perm const &perm) const
-{ return mpsym::util::container_hash(perm._perm.begin() + 1u, perm._perm.end()); }
+{
+  if (perm.small()) {
+    return mpsym::util::container_hash(perm._perm_small + 1u,
+                                       perm._perm_small + perm.degree());
+  }
+
+  return mpsym::util::container_hash(perm._perm_large + 1u,
+                                     perm._perm_large + perm.degree());
+}
 
 } // namespace std
@@ -227,7 +227,7 @@ bool PermGroup::contains_element(Perm const &perm) const
 
 Perm PermGroup::random_element() const
 {
-  static auto re(util::random_engine());
+  static thread_local auto re(util::random_engine());
 
   Perm result(degree());
   for (unsigned i = 0u; i < _bsgs.base_size(); ++i) {
@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "perm.hpp"
+#include "perm_matrix.hpp"
+#include "perm_set.hpp"
+
+namespace
+{
+
+constexpr unsigned PADDING = 32u;
+
+template<typename T>
+void compose_kernel(T const *lhs, T const *rhs, T *res, unsigned degree)
+{
+  for (unsigned i = 0u; i < degree; ++i)
+    res[i] = rhs[lhs[i]];
+}
+
+#ifdef __AVX2__
+
+// rhs images are fetched with 32-bit gathers and masked, this reads up to
+// three bytes past the end of rhs which is why PermMatrix pads its buffer
+
+template<>
+void compose_kernel<uint8_t>(uint8_t const *lhs,
+                             uint8_t const *rhs,
+                             uint8_t *res,
+                             unsigned degree)
+{
+  __m256i const mask = _mm256_set1_epi32(0xFF);
+
+  unsigned i = 0u;
+  for (; i + 8u <= degree; i += 8u) {
+    __m128i idx8 = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(lhs + i));
+    __m256i idx = _mm256_cvtepu8_epi32(idx8);
+
+    __m256i img = _mm256_i32gather_epi32(
+      reinterpret_cast<int const *>(rhs), idx, 1);
+
+    img = _mm256_and_si256(img, mask);
+    img = _mm256_packus_epi32(img, img);
+    img = _mm256_packus_epi16(img, img);
+
+    int32_t lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(img));
+    int32_t hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(img, 1));
+
+    std::memcpy(res + i, &lo, 4u);
+    std::memcpy(res + i + 4u, &hi, 4u);
+  }
+
+  for (; i < degree; ++i)
+    res[i] = rhs[lhs[i]];
+}
+
+template<>
+void compose_kernel<uint16_t>(uint16_t const *lhs,
+                              uint16_t const *rhs,
+                              uint16_t *res,
+                              unsigned degree)
+{
+  __m256i const mask = _mm256_set1_epi32(0xFFFF);
+
+  unsigned i = 0u;
+  for (; i + 8u <= degree; i += 8u) {
+    __m128i idx16 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(lhs + i));
+    __m256i idx = _mm256_cvtepu16_epi32(idx16);
+
+    __m256i img = _mm256_i32gather_epi32(
+      reinterpret_cast<int const *>(rhs), idx, 2);
+
+    img = _mm256_and_si256(img, mask);
+    img = _mm256_packus_epi32(img, img);
+    img = _mm256_permute4x64_epi64(img, 0x08);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(res + i),
+                     _mm256_castsi256_si128(img));
+  }
+
+  for (; i < degree; ++i)
+    res[i] = rhs[lhs[i]];
+}
+
+template<>
+void compose_kernel<uint32_t>(uint32_t const *lhs,
+                              uint32_t const *rhs,
+                              uint32_t *res,
+                              unsigned degree)
+{
+  unsigned i = 0u;
+  for (; i + 8u <= degree; i += 8u) {
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(lhs + i));
+
+    __m256i img = _mm256_i32gather_epi32(
+      reinterpret_cast<int const *>(rhs), idx, 4);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(res + i), img);
+  }
+
+  for (; i < degree; ++i)
+    res[i] = rhs[lhs[i]];
+}
+
+#endif // __AVX2__
+
+// there is no AVX2 scatter instruction, inversion is always scalar
+template<typename T>
+void invert_kernel(T const *perm, T *res, unsigned degree)
+{
+  for (unsigned i = 0u; i < degree; ++i)
+    res[perm[i]] = static_cast<T>(i);
+}
+
+template<typename T>
+void set_kernel(mpsym::internal::Perm const &perm, T *res)
+{
+  for (unsigned i = 0u; i < perm.degree(); ++i)
+    res[i] = static_cast<T>(perm[i]);
+}
+
+template<typename T>
+void set_images_kernel(unsigned const *images, T *res, unsigned degree)
+{
+  for (unsigned i = 0u; i < degree; ++i)
+    res[i] = static_cast<T>(images[i]);
+}
+
+template<typename T>
+void set_inverse_kernel(mpsym::internal::Perm const &perm, T *res)
+{
+  for (unsigned i = 0u; i < perm.degree(); ++i)
+    res[perm[i]] = static_cast<T>(i);
+}
+
+template<typename T>
+void set_identity_kernel(T *res, unsigned degree)
+{
+  for (unsigned i = 0u; i < degree; ++i)
+    res[i] = static_cast<T>(i);
+}
+
+template<typename T>
+bool id_kernel(T const *perm, unsigned degree)
+{
+  for (unsigned i = 0u; i < degree; ++i) {
+    if (perm[i] != i)
+      return false;
+  }
+
+  return true;
+}
+
+uint32_t min_kernel(uint32_t const *images, unsigned n)
+{
+  uint32_t res = std::numeric_limits<uint32_t>::max();
+
+  unsigned i = 0u;
+
+#ifdef __AVX2__
+  if (n >= 8u) {
+    __m256i min = _mm256_set1_epi32(-1);
+
+    for (; i + 8u <= n; i += 8u) {
+      min = _mm256_min_epu32(
+        min, _mm256_loadu_si256(reinterpret_cast<__m256i const *>(images + i)));
+    }
+
+    uint32_t mins[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(mins), min);
+
+    for (uint32_t m : mins)
+      res = std::min(res, m);
+  }
+#endif
+
+  for (; i < n; ++i)
+    res = std::min(res, images[i]);
+
+  return res;
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+PermMatrix::PermMatrix(unsigned degree, unsigned rows)
+: _degree(degree),
+  _rows(0u)
+{
+  assert(degree > 0u);
+
+  if (degree - 1u <= std::numeric_limits<uint8_t>::max())
+    _width = 1u;
+  else if (degree - 1u <= std::numeric_limits<uint16_t>::max())
+    _width = 2u;
+  else
+    _width = 4u;
+
+  resize(rows);
+}
+
+PermMatrix::PermMatrix(PermSet const &perms)
+: PermMatrix(perms.empty() ? 1u : perms.degree())
+{
+  resize(perms.size());
+
+  for (unsigned r = 0u; r < perms.size(); ++r)
+    set(r, perms[r]);
+}
+
+void PermMatrix::resize(unsigned rows)
+{
+  unsigned rows_old = _rows;
+
+  _rows = rows;
+  _data.resize(_rows * _degree * _width + PADDING);
+
+  for (unsigned r = rows_old; r < _rows; ++r)
+    set_identity(r);
+}
+
+void PermMatrix::set(unsigned r, Perm const &perm)
+{
+  assert(r < _rows);
+  assert(perm.degree() == _degree);
+
+  switch (_width) {
+    case 1u:
+      set_kernel(perm, row<uint8_t>(r));
+      break;
+    case 2u:
+      set_kernel(perm, row<uint16_t>(r));
+      break;
+    default:
+      set_kernel(perm, row<uint32_t>(r));
+  }
+}
+
+void PermMatrix::set(unsigned r, unsigned const *images)
+{
+  assert(r < _rows);
+
+  switch (_width) {
+    case 1u:
+      set_images_kernel(images, row<uint8_t>(r), _degree);
+      break;
+    case 2u:
+      set_images_kernel(images, row<uint16_t>(r), _degree);
+      break;
+    default:
+      set_images_kernel(images, row<uint32_t>(r), _degree);
+  }
+}
+
+void PermMatrix::set_identity(unsigned r)
+{
+  assert(r < _rows);
+
+  switch (_width) {
+    case 1u:
+      set_identity_kernel(row<uint8_t>(r), _degree);
+      break;
+    case 2u:
+      set_identity_kernel(row<uint16_t>(r), _degree);
+      break;
+    default:
+      set_identity_kernel(row<uint32_t>(r), _degree);
+  }
+}
+
+void PermMatrix::set_inverse(unsigned r, Perm const &perm)
+{
+  assert(r < _rows);
+  assert(perm.degree() == _degree);
+
+  switch (_width) {
+    case 1u:
+      set_inverse_kernel(perm, row<uint8_t>(r));
+      break;
+    case 2u:
+      set_inverse_kernel(perm, row<uint16_t>(r));
+      break;
+    default:
+      set_inverse_kernel(perm, row<uint32_t>(r));
+  }
+}
+
+void PermMatrix::get(unsigned r, Perm &perm) const
+{
+  assert(r < _rows);
+
+  perm.resize(_degree);
+
+  for (unsigned i = 0u; i < _degree; ++i)
+    perm.set(i, image(r, i));
+}
+
+bool PermMatrix::id(unsigned r) const
+{
+  assert(r < _rows);
+
+  switch (_width) {
+    case 1u:
+      return id_kernel(row<uint8_t>(r), _degree);
+    case 2u:
+      return id_kernel(row<uint16_t>(r), _degree);
+    default:
+      return id_kernel(row<uint32_t>(r), _degree);
+  }
+}
+
+void PermMatrix::compose(unsigned lhs, unsigned rhs, unsigned res)
+{
+  assert(lhs < _rows && rhs < _rows && res < _rows);
+  assert(res != rhs);
+
+  switch (_width) {
+    case 1u:
+      compose_kernel(row<uint8_t>(lhs), row<uint8_t>(rhs), row<uint8_t>(res), _degree);
+      break;
+    case 2u:
+      compose_kernel(row<uint16_t>(lhs), row<uint16_t>(rhs), row<uint16_t>(res), _degree);
+      break;
+    default:
+      compose_kernel(row<uint32_t>(lhs), row<uint32_t>(rhs), row<uint32_t>(res), _degree);
+  }
+}
+
+void PermMatrix::invert(unsigned r, unsigned res)
+{
+  assert(r < _rows && res < _rows);
+  assert(r != res);
+
+  switch (_width) {
+    case 1u:
+      invert_kernel(row<uint8_t>(r), row<uint8_t>(res), _degree);
+      break;
+    case 2u:
+      invert_kernel(row<uint16_t>(r), row<uint16_t>(res), _degree);
+      break;
+    default:
+      invert_kernel(row<uint32_t>(r), row<uint32_t>(res), _degree);
+  }
+}
+
+TransposedPermMatrix::TransposedPermMatrix(PermSet const &perms)
+: _degree(perms.empty() ? 0u : perms.degree()),
+  _cols(static_cast<unsigned>(perms.size())),
+  _images(static_cast<std::size_t>(_degree) * _cols)
+{
+  for (unsigned c = 0u; c < _cols; ++c) {
+    for (unsigned x = 0u; x < _degree; ++x)
+      _images[x * _cols + c] = perms[c][x];
+  }
+}
+
+unsigned TransposedPermMatrix::min_image(unsigned const *tasks,
+                                         unsigned num_tasks,
+                                         unsigned offset,
+                                         std::vector<unsigned> &candidates) const
+{
+  // candidates are the permutations whose images of all tasks considered so
+  // far are minimal, as long as this includes all permutations the (much
+  // faster) contiguous kernel is used
+  bool all = true;
+
+  // tasks itself is among the minimal images
+  bool identity = true;
+
+  for (unsigned i = 0u; i < num_tasks; ++i) {
+    unsigned task = tasks[i];
+    if (task < offset || task >= _degree + offset)
+      continue;
+
+    unsigned x = task - offset;
+    uint32_t const *images = _images.data() + x * _cols;
+
+    uint32_t min;
+    if (all) {
+      min = min_kernel(images, _cols);
+    } else {
+      min = std::numeric_limits<uint32_t>::max();
+      for (unsigned c : candidates)
+        min = std::min(min, images[c]);
+    }
+
+    if (identity) {
+      if (min > x)
+        return _cols;
+
+      if (min < x)
+        identity = false;
+    }
+
+    if (all) {
+      if (static_cast<unsigned>(std::count(images, images + _cols, min)) == _cols)
+        continue;
+
+      candidates.clear();
+      for (unsigned c = 0u; c < _cols; ++c) {
+        if (images[c] == min)
+          candidates.push_back(c);
+      }
+
+      all = false;
+
+    } else {
+      candidates.erase(std::remove_if(candidates.begin(),
+                                      candidates.end(),
+                                      [&](unsigned c){ return images[c] != min; }),
+                       candidates.end());
+    }
+
+    if (!identity && candidates.size() == 1u)
+      return candidates[0];
+  }
+
+  if (identity || _cols == 0u)
+    return _cols;
+
+  return all ? 0u : candidates[0];
+}
+
+bool TransposedPermMatrix::less_than(unsigned c,
+                                     unsigned const *tasks,
+                                     unsigned num_tasks,
+                                     unsigned offset) const
+{
+  for (unsigned i = 0u; i < num_tasks; ++i) {
+    unsigned task = tasks[i];
+    if (task < offset || task >= _degree + offset)
+      continue;
+
+    unsigned task_permuted = image(c, task - offset) + offset;
+
+    if (task_permuted != task)
+      return task_permuted < task;
+  }
+
+  return false;
+}
+
+void TransposedPermMatrix::permute(unsigned c,
+                                   unsigned *tasks,
+                                   unsigned num_tasks,
+                                   unsigned offset) const
+{
+  for (unsigned i = 0u; i < num_tasks; ++i) {
+    unsigned task = tasks[i];
+    if (task < offset || task >= _degree + offset)
+      continue;
+
+    tasks[i] = image(c, task - offset) + offset;
+  }
+}
+
+} // namespace internal
+
+} // namespace mpsym
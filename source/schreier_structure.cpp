@@ -0,0 +1,22 @@
+#include "perm.hpp"
+#include "schreier_structure.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+void SchreierStructure::transversal_apply_inverse(unsigned origin,
+                                                  unsigned *first,
+                                                  unsigned *last) const
+{
+  Perm transversal_inverse(~transversal(origin));
+
+  for (unsigned *it = first; it != last; ++it)
+    *it = transversal_inverse[*it];
+}
+
+} // namespace internal
+
+} // namespace mpsym
@@ -1,9 +1,6 @@
-#include <algorithm>
 #include <cassert>
-#include <map>
-#include <memory>
+#include <cstdint>
 #include <ostream>
-#include <utility>
 #include <vector>
 
 #include "perm.hpp"
@@ -16,12 +13,41 @@ namespace mpsym
 namespace internal
 {
 
+constexpr uint32_t SchreierTree::NO_EDGE;
+
+SchreierTree::SchreierTree(unsigned degree, unsigned root, PermSet const &labels)
+: _degree(degree),
+  _root(root),
+  _edges(degree, NO_EDGE),
+  _edge_labels(degree, NO_EDGE),
+  _word_lengths(degree, 0u)
+{
+  for (Perm const &label : labels)
+    add_label(label);
+}
+
+void SchreierTree::add_label(Perm const &label)
+{
+  assert(label.degree() == _degree);
+
+  _labels.insert(label);
+
+  _inverse_labels.resize(_inverse_labels.size() + _degree);
+
+  unsigned *inverse = _inverse_labels.data() + _inverse_labels.size() - _degree;
+  for (unsigned x = 0u; x < _degree; ++x)
+    inverse[label[x]] = x;
+}
+
 void SchreierTree::create_edge(
   unsigned origin, unsigned destination, unsigned label)
 {
+  // edges always point to nodes already contained in the tree
+  assert(contains(destination));
 
   _edges[origin] = destination;
   _edge_labels[origin] = label;
+  _word_lengths[origin] = _word_lengths[destination] + 1u;
 }
 
 unsigned SchreierTree::root() const { return _root; }
@@ -30,8 +56,10 @@ std::vector<unsigned> SchreierTree::nodes() const
 {
   std::vector<unsigned> result {_root};
 
-  for (auto const &node : _edges)
-    result.push_back(node.first);
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (x != _root && _edges[x] != NO_EDGE)
+      result.push_back(x);
+  }
 
   return result;
 }
@@ -43,62 +71,77 @@ PermSet SchreierTree::labels() const
 
 bool SchreierTree::contains(unsigned node) const
 {
-  return (node == _root) || (_edges.find(node) != _edges.end());
+  return node == _root || _edges[node] != NO_EDGE;
 }
 
 bool SchreierTree::incoming(unsigned node, Perm const &edge) const
 {
   assert(edge.degree() == _degree);
 
-  auto it = _edge_labels.find(edge[node]);
-  if (it == _edge_labels.end())
+  unsigned destination = edge[node];
+
+  if (destination == _root || _edges[destination] == NO_EDGE)
     return false;
 
-  return _labels[it->second] == edge;
+  return _labels[_edge_labels[destination]] == edge;
 }
 
 Perm SchreierTree::transversal(unsigned origin) const
 {
-  Perm result(_degree);
+  assert(contains(origin));
+
+  // labels along the path from origin to the root
+  std::vector<Perm const *> path;
+  path.reserve(_word_lengths[origin]);
 
   unsigned current = origin;
-  while(current != _root) {
-    Perm const &label = _labels[_edge_labels.find(current)->second];
-    result = label * result;
-    current = _edges.find(current)->second;
+  while (current != _root) {
+    path.push_back(&_labels[_edge_labels[current]]);
+    current = _edges[current];
   }
 
-  return result;
+  // apply them starting at the root without creating intermediate perms
+  std::vector<unsigned> result(_degree);
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    unsigned y = x;
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+      y = (**it)[y];
+
+    result[x] = y;
+  }
+
+  return Perm(result);
 }
 
-void SchreierTree::dump(std::ostream &os) const
+void SchreierTree::transversal_apply_inverse(unsigned origin,
+                                             unsigned *first,
+                                             unsigned *last) const
 {
-  std::vector<std::vector<std::pair<unsigned, unsigned>>> adj(_degree + 1u);
+  assert(contains(origin));
+
+  // the inverted transversal applies the inverted labels from origin upwards
+  unsigned current = origin;
+  while (current != _root) {
+    unsigned const *inverse = inverse_label(_edge_labels[current]);
 
-  for (auto const &e : _edges) {
-    auto label_it = _edge_labels.find(e.first);
+    for (unsigned *it = first; it != last; ++it)
+      *it = inverse[*it];
 
-    adj[e.first].emplace_back(e.second, label_it->second);
+    current = _edges[current];
   }
+}
 
+void SchreierTree::dump(std::ostream &os) const
+{
   os << "schreier tree: [\n";
 
-  for (auto origin = 1u; origin <= _degree; ++ origin) {
-    if (adj[origin].empty())
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (x == _root || _edges[x] == NO_EDGE)
       continue;
 
-    os << "  " << origin << ": [";
-
-    for (auto i = 0u; i < adj[origin].size(); ++i) {
-      auto e = adj[origin][i];
-
-      os << e.first << " " << _labels[e.second];
-
-      if (i < adj[origin].size() - 1u)
-        os << ", ";
-    }
-
-    os << "]\n";
+    os << "  " << x << ": [" << _edges[x] << " "
+       << _labels[_edge_labels[x]] << "]\n";
   }
 
   os << "]\n";
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "shallow_schreier_tree.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+bool ShallowSchreierTree::incoming(unsigned node, Perm const &edge) const
+{
+  assert(edge.degree() == _degree);
+
+  update();
+
+  int label = _edge_labels[edge[node]];
+  if (label == -1)
+    return false;
+
+  return _cube_labels[label] == edge;
+}
+
+Perm ShallowSchreierTree::transversal(unsigned origin) const
+{
+  update();
+
+  Perm result(_degree);
+
+  unsigned current = origin;
+  while (current != _root) {
+    assert(_edge_labels[current] != -1);
+
+    result = _cube_labels[_edge_labels[current]] * result;
+    current = _edges[current];
+  }
+
+  return result;
+}
+
+void ShallowSchreierTree::transversal_apply_inverse(unsigned origin,
+                                                    unsigned *first,
+                                                    unsigned *last) const
+{
+  update();
+
+  // the second half of the cube labels are the inverses of the first half
+  unsigned num_cube = static_cast<unsigned>(_cube_labels.size()) / 2u;
+
+  unsigned current = origin;
+  while (current != _root) {
+    assert(_edge_labels[current] != -1);
+
+    unsigned label = static_cast<unsigned>(_edge_labels[current]);
+    Perm const &inverse = _cube_labels[(label + num_cube) % (2u * num_cube)];
+
+    for (unsigned *it = first; it != last; ++it)
+      *it = inverse[*it];
+
+    current = _edges[current];
+  }
+}
+
+unsigned ShallowSchreierTree::depth() const
+{
+  update();
+
+  return _depth;
+}
+
+void ShallowSchreierTree::update() const
+{
+  if (_valid)
+    return;
+
+  std::lock_guard<std::mutex> lock(_update_mtx);
+
+  if (_valid)
+    return;
+
+  // adjoin cube generators u_gamma until root^(C * C^-1) covers the orbit,
+  // every such generator at least doubles |C| and the resulting tree has
+  // depth at most 2 * |cube|
+  std::vector<Perm> cube;
+  std::vector<bool> covered(cube_orbit(cube));
+
+  for (unsigned gamma : _tree.nodes()) {
+    if (covered[gamma])
+      continue;
+
+    cube.push_back(_tree.transversal(gamma));
+    covered = cube_orbit(cube);
+  }
+
+  _cube_labels = cube;
+  for (Perm const &perm : cube)
+    _cube_labels.push_back(~perm);
+
+  // construct tree via breadth first search over cube labels and inverses
+  _edges.assign(_degree, _root);
+  _edge_labels.assign(_degree, -1);
+  _depth = 0u;
+
+  std::vector<bool> done(_degree, false);
+  done[_root] = true;
+
+  std::vector<unsigned> level {_root};
+  std::vector<unsigned> level_next;
+
+  while (!level.empty()) {
+    level_next.clear();
+
+    for (unsigned x : level) {
+      for (unsigned i = 0u; i < _cube_labels.size(); ++i) {
+        unsigned y = _cube_labels[i][x];
+
+        if (!done[y]) {
+          done[y] = true;
+
+          _edges[y] = x;
+          _edge_labels[y] = static_cast<int>(i);
+
+          level_next.push_back(y);
+        }
+      }
+    }
+
+    if (!level_next.empty())
+      ++_depth;
+
+    std::swap(level, level_next);
+  }
+
+  _valid = true;
+}
+
+std::vector<bool> ShallowSchreierTree::cube_orbit(
+  std::vector<Perm> const &cube) const
+{
+  // the cube C = {g_k^e_k * ... * g_1^e_1 | e_i in {0, 1}} (where g_k is
+  // applied first) is extended by prepending new generators
+  std::vector<bool> res(_degree, false);
+  res[_root] = true;
+
+  std::vector<unsigned> orbit {_root};
+
+  auto extend = [&](Perm const &perm, bool invert) {
+    Perm perm_(invert ? ~perm : perm);
+
+    for (unsigned i = 0u, n = orbit.size(); i < n; ++i) {
+      unsigned y = perm_[orbit[i]];
+
+      if (!res[y]) {
+        res[y] = true;
+        orbit.push_back(y);
+      }
+    }
+  };
+
+  // root^C
+  for (auto it = cube.rbegin(); it != cube.rend(); ++it)
+    extend(*it, false);
+
+  // root^(C * C^-1)
+  for (auto it = cube.begin(); it != cube.end(); ++it)
+    extend(*it, true);
+
+  return res;
+}
+
+void ShallowSchreierTree::dump(std::ostream &os) const
+{
+  update();
+
+  std::vector<std::vector<std::pair<unsigned, unsigned>>> adj(_degree);
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (_edge_labels[x] != -1)
+      adj[x].emplace_back(_edges[x], _edge_labels[x]);
+  }
+
+  os << "shallow schreier tree: [\n";
+
+  for (auto origin = 0u; origin < _degree; ++origin) {
+    if (adj[origin].empty())
+      continue;
+
+    os << "  " << origin << ": [";
+
+    for (auto i = 0u; i < adj[origin].size(); ++i) {
+      auto e = adj[origin][i];
+
+      os << e.first << " " << _cube_labels[e.second];
+
+      if (i < adj[origin].size() - 1u)
+        os << ", ";
+    }
+
+    os << "]\n";
+  }
+
+  os << "]\n";
+}
+
+} // namespace internal
+
+} // namespace mpsym
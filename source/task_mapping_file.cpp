@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
+
+// Task mapping files consist of a header of native endian 32-bit words:
+//
+// magic (2 words), version, byte order mark, number of tasks per mapping,
+// number of processors, bytes per task (1, 2 or 4), number of mappings (low
+// and high word), reserved (zero)
+//
+// followed by one row of tasks (stored with the given number of bytes each)
+// per mapping
+
+namespace
+{
+
+constexpr char MAGIC[8] = {'M', 'P', 'S', 'Y', 'M', 'T', 'M', 'F'};
+constexpr uint32_t VERSION = 1u;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+constexpr std::size_t HEADER_WORDS = 10u;
+constexpr std::size_t HEADER_BYTES = HEADER_WORDS * sizeof(uint32_t);
+
+unsigned bytes_per_task(unsigned num_processors)
+{
+  if (num_processors <= (1u << 8))
+    return 1u;
+  if (num_processors <= (1u << 16))
+    return 2u;
+
+  return 4u;
+}
+
+void encode_task(unsigned task, unsigned bytes, unsigned char *dest)
+{
+  switch (bytes) {
+  case 1u:
+    *dest = static_cast<uint8_t>(task);
+    break;
+  case 2u:
+    {
+      uint16_t task16 = static_cast<uint16_t>(task);
+      std::memcpy(dest, &task16, sizeof(task16));
+    }
+    break;
+  default:
+    {
+      uint32_t task32 = static_cast<uint32_t>(task);
+      std::memcpy(dest, &task32, sizeof(task32));
+    }
+    break;
+  }
+}
+
+unsigned decode_task(unsigned char const *src, unsigned bytes)
+{
+  switch (bytes) {
+  case 1u:
+    return *src;
+  case 2u:
+    {
+      uint16_t task16;
+      std::memcpy(&task16, src, sizeof(task16));
+      return task16;
+    }
+  default:
+    {
+      uint32_t task32;
+      std::memcpy(&task32, src, sizeof(task32));
+      return task32;
+    }
+  }
+}
+
+// mapping(i) must point to the num_tasks tasks of the i-th mapping
+void save_mappings(std::string const &file,
+                   std::size_t num_mappings,
+                   std::size_t num_tasks,
+                   unsigned num_processors,
+                   std::function<unsigned const *(std::size_t)> const &mapping)
+{
+  if (num_processors == 0u) {
+    for (std::size_t i = 0u; i < num_mappings; ++i) {
+      unsigned const *tasks = mapping(i);
+
+      if (num_tasks > 0u)
+        num_processors = std::max(num_processors,
+                                  *std::max_element(tasks, tasks + num_tasks) + 1u);
+    }
+  }
+
+  unsigned bytes = bytes_per_task(num_processors);
+
+  uint32_t header[HEADER_WORDS];
+  std::memcpy(header, MAGIC, sizeof(MAGIC));
+  header[2] = VERSION;
+  header[3] = BYTE_ORDER_MARK;
+  header[4] = static_cast<uint32_t>(num_tasks);
+  header[5] = num_processors;
+  header[6] = bytes;
+  header[7] = static_cast<uint32_t>(num_mappings & 0xFFFFFFFFu);
+  header[8] = static_cast<uint32_t>(static_cast<uint64_t>(num_mappings) >> 32);
+  header[9] = 0u;
+
+  // write to a temporary file first such that concurrent readers never
+  // observe partially written files
+  std::string file_tmp(file + ".tmp." + std::to_string(getpid()));
+
+  {
+    std::ofstream os(file_tmp, std::ios::binary | std::ios::trunc);
+
+    os.write(reinterpret_cast<char const *>(header), sizeof(header));
+
+    if (!os) {
+      os.close();
+      std::remove(file_tmp.c_str());
+      throw std::runtime_error("failed to write " + file_tmp);
+    }
+
+    std::vector<unsigned char> row(num_tasks * bytes);
+
+    for (std::size_t i = 0u; i < num_mappings; ++i) {
+      unsigned const *tasks = mapping(i);
+
+      for (std::size_t j = 0u; j < num_tasks; ++j) {
+        if (tasks[j] >= num_processors) {
+          os.close();
+          std::remove(file_tmp.c_str());
+          throw std::invalid_argument("task mapping exceeds number of processors");
+        }
+
+        encode_task(tasks[j], bytes, row.data() + j * bytes);
+      }
+
+      os.write(reinterpret_cast<char const *>(row.data()), row.size());
+    }
+
+    os.close();
+
+    if (!os) {
+      std::remove(file_tmp.c_str());
+      throw std::runtime_error("failed to write " + file_tmp);
+    }
+  }
+
+  if (std::rename(file_tmp.c_str(), file.c_str()) != 0) {
+    std::remove(file_tmp.c_str());
+    throw std::runtime_error("failed to rename " + file_tmp + " to " + file);
+  }
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+TaskMappingView::TaskMappingView(std::string const &file)
+{
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw std::runtime_error("failed to open " + file);
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw std::runtime_error("failed to stat " + file);
+  }
+
+  std::size_t size = static_cast<std::size_t>(st.st_size);
+
+  if (size < HEADER_BYTES) {
+    close(fd);
+    throw std::runtime_error("not a task mapping file: " + file);
+  }
+
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("failed to map " + file);
+
+  // unmapped once the last view is destroyed
+  _data = std::shared_ptr<void const>(
+    addr, [size](void const *addr) { munmap(const_cast<void *>(addr), size); });
+
+  uint32_t header[HEADER_WORDS];
+  std::memcpy(header, addr, sizeof(header));
+
+  if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0)
+    throw std::runtime_error("not a task mapping file: " + file);
+
+  if (header[2] != VERSION)
+    throw std::runtime_error("unsupported task mapping file version: " + file);
+
+  if (header[3] != BYTE_ORDER_MARK)
+    throw std::runtime_error("task mapping file has wrong byte order: " + file);
+
+  _num_tasks = header[4];
+  _num_processors = header[5];
+  _task_bytes = header[6];
+  _num_mappings = static_cast<std::size_t>(
+    static_cast<uint64_t>(header[7]) | static_cast<uint64_t>(header[8]) << 32);
+
+  if (_task_bytes != bytes_per_task(_num_processors))
+    throw std::runtime_error("malformed task mapping file " + file);
+
+  std::size_t row_bytes = static_cast<std::size_t>(_num_tasks) * _task_bytes;
+
+  if (row_bytes > 0u && _num_mappings > (size - HEADER_BYTES) / row_bytes)
+    throw std::runtime_error("truncated task mapping file " + file);
+
+  if (HEADER_BYTES + _num_mappings * row_bytes != size)
+    throw std::runtime_error("malformed task mapping file " + file);
+
+  _rows = static_cast<unsigned char const *>(addr) + HEADER_BYTES;
+}
+
+bool TaskMappingView::is_task_mapping_file(std::string const &file)
+{
+  std::ifstream is(file, std::ios::binary);
+
+  char magic[sizeof(MAGIC)];
+  if (!is.read(magic, sizeof(magic)))
+    return false;
+
+  return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void TaskMappingView::save(std::string const &file,
+                           TaskMapping const *mappings,
+                           std::size_t num_mappings,
+                           unsigned num_processors)
+{
+  std::size_t num_tasks = num_mappings > 0u ? mappings[0].size() : 0u;
+
+  for (std::size_t i = 1u; i < num_mappings; ++i) {
+    if (mappings[i].size() != num_tasks)
+      throw std::invalid_argument("task mappings must all have the same length");
+  }
+
+  save_mappings(file,
+                num_mappings,
+                num_tasks,
+                num_processors,
+                [&](std::size_t i){ return mappings[i].data(); });
+}
+
+void TaskMappingView::save_flat(std::string const &file,
+                                unsigned const *mappings,
+                                std::size_t num_mappings,
+                                std::size_t mapping_size,
+                                unsigned num_processors)
+{
+  save_mappings(file,
+                num_mappings,
+                mapping_size,
+                num_processors,
+                [&](std::size_t i){ return mappings + i * mapping_size; });
+}
+
+unsigned TaskMappingView::task(std::size_t i, unsigned j) const
+{
+  if (i >= _num_mappings || j >= _num_tasks)
+    throw std::out_of_range("task mapping index out of range");
+
+  return decode_task(row(i) + j * _task_bytes, _task_bytes);
+}
+
+TaskMapping TaskMappingView::operator[](std::size_t i) const
+{
+  std::vector<unsigned> tasks(_num_tasks);
+  copy(i, tasks.data());
+
+  return TaskMapping(tasks);
+}
+
+void TaskMappingView::copy(std::size_t i, unsigned *tasks) const
+{
+  if (i >= _num_mappings)
+    throw std::out_of_range("task mapping index out of range");
+
+  unsigned char const *r = row(i);
+
+  switch (_task_bytes) {
+  case 1u:
+    std::copy(r, r + _num_tasks, tasks);
+    break;
+  default:
+    for (unsigned j = 0u; j < _num_tasks; ++j)
+      tasks[j] = decode_task(r + j * _task_bytes, _task_bytes);
+    break;
+  }
+}
+
+TaskMappingView TaskMappingView::slice(std::size_t first,
+                                       std::size_t num_mappings) const
+{
+  if (first > _num_mappings || num_mappings > _num_mappings - first)
+    throw std::out_of_range("task mapping slice out of range");
+
+  TaskMappingView res(*this);
+  res._rows = row(first);
+  res._num_mappings = num_mappings;
+
+  return res;
+}
+
+} // namespace mpsym
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "task_mapping.hpp"
+#include "task_mapping_memo.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+constexpr unsigned TaskMappingMemo::DEFAULT_NUM_SHARDS;
+constexpr std::size_t TaskMappingMemo::MIN_SHARD_CAPACITY;
+
+TaskMappingMemo::TaskMappingMemo(std::size_t capacity, unsigned num_shards)
+: _capacity(capacity),
+  _hits(0u),
+  _misses(0u),
+  _evictions(0u)
+{
+  // small shards would evict entries long before the memo is full since
+  // mappings are not distributed evenly among them
+  std::size_t num_shards_ = std::max(
+    std::min(static_cast<std::size_t>(num_shards),
+             capacity / MIN_SHARD_CAPACITY),
+    static_cast<std::size_t>(1u));
+
+  for (std::size_t i = 0u; i < num_shards_; ++i) {
+    _shards.emplace_back(new Shard);
+
+    auto &s(*_shards.back());
+    s.capacity = capacity / num_shards_ + (i < capacity % num_shards_ ? 1u : 0u);
+  }
+}
+
+std::size_t TaskMappingMemo::size() const
+{
+  std::size_t res = 0u;
+
+  for (auto const &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->mtx);
+    res += s->entries.size();
+  }
+
+  return res;
+}
+
+bool TaskMappingMemo::lookup(TaskMapping const &mapping,
+                             uint64_t tag,
+                             TaskMapping &representative,
+                             unsigned &orbit_index)
+{
+  auto &s(shard(mapping));
+
+  {
+    std::lock_guard<std::mutex> lock(s.mtx);
+
+    auto it(s.index.find({mapping, tag}));
+
+    if (it != s.index.end()) {
+      auto &entry(s.entries[it->second]);
+
+      entry.referenced = true;
+
+      representative = entry.representative;
+      orbit_index = entry.orbit_index;
+
+      ++_hits;
+
+      return true;
+    }
+  }
+
+  ++_misses;
+
+  return false;
+}
+
+void TaskMappingMemo::insert(TaskMapping const &mapping,
+                             uint64_t tag,
+                             TaskMapping const &representative,
+                             unsigned orbit_index)
+{
+  auto &s(shard(mapping));
+
+  if (s.capacity == 0u)
+    return;
+
+  std::lock_guard<std::mutex> lock(s.mtx);
+
+  Key key{mapping, tag};
+
+  // another thread might have inserted the same mapping in the meantime
+  if (s.index.find(key) != s.index.end())
+    return;
+
+  if (s.entries.size() < s.capacity) {
+    s.index[key] = s.entries.size();
+    s.entries.push_back({key, representative, orbit_index, false});
+    return;
+  }
+
+  for (;;) {
+    auto &entry(s.entries[s.hand]);
+
+    if (!entry.referenced)
+      break;
+
+    entry.referenced = false;
+
+    s.hand = (s.hand + 1u) % s.entries.size();
+  }
+
+  auto &victim(s.entries[s.hand]);
+
+  s.index.erase(victim.key);
+  s.index[key] = s.hand;
+
+  victim = {key, representative, orbit_index, false};
+
+  s.hand = (s.hand + 1u) % s.entries.size();
+
+  ++_evictions;
+}
+
+TaskMappingMemo::Stats TaskMappingMemo::stats() const
+{
+  Stats res;
+  res.hits = _hits.load();
+  res.misses = _misses.load();
+  res.evictions = _evictions.load();
+
+  return res;
+}
+
+TaskMappingMemo::Shard &TaskMappingMemo::shard(TaskMapping const &mapping) const
+{ return *_shards[std::hash<TaskMapping>()(mapping) % _shards.size()]; }
+
+} // namespace internal
+
+} // namespace mpsym
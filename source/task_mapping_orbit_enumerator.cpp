@@ -0,0 +1,494 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_orbit_enumerator.hpp"
+#include "thread_pool.hpp"
+
+namespace
+{
+
+using mpsym::TaskMapping;
+using mpsym::internal::PermSet;
+using mpsym::internal::TaskMappingRanking;
+using mpsym::internal::ThreadPool;
+
+using rank_type = TaskMappingRanking::rank_type;
+
+// set of ranks in [0, n) represented by one bit each
+class AtomicBitmap
+{
+public:
+  explicit AtomicBitmap(uint64_t n)
+  : _num_words(static_cast<std::size_t>((n + 63u) / 64u)),
+    _words(new std::atomic<uint64_t>[_num_words])
+  {
+    for (std::size_t i = 0u; i < _num_words; ++i)
+      _words[i].store(0u, std::memory_order_relaxed);
+  }
+
+  void reserve(std::size_t)
+  {}
+
+  bool insert(uint64_t rank)
+  {
+    uint64_t mask = 1ULL << (rank % 64u);
+
+    uint64_t word = _words[rank / 64u].fetch_or(mask, std::memory_order_relaxed);
+
+    return !(word & mask);
+  }
+
+private:
+  std::size_t _num_words;
+  std::unique_ptr<std::atomic<uint64_t>[]> _words;
+};
+
+// open addressing hash table of 64-bit ranks, insertions are lock-free but the
+// table can only be grown (via reserve) while no insertions are in progress
+class RankTable
+{
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+
+public:
+  void reserve(std::size_t n)
+  {
+    std::size_t capacity = 16u;
+    while (capacity < 2u * n)
+      capacity *= 2u;
+
+    if (capacity <= _capacity)
+      return;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> slots(
+      new std::atomic<uint64_t>[capacity]);
+
+    for (std::size_t i = 0u; i < capacity; ++i)
+      slots[i].store(EMPTY, std::memory_order_relaxed);
+
+    std::swap(slots, _slots);
+    std::swap(capacity, _capacity);
+
+    for (std::size_t i = 0u; i < capacity; ++i) {
+      uint64_t rank = slots[i].load(std::memory_order_relaxed);
+
+      if (rank != EMPTY)
+        insert(rank);
+    }
+  }
+
+  bool insert(uint64_t rank)
+  {
+    assert(rank != EMPTY);
+
+    std::size_t mask = _capacity - 1u;
+
+    for (std::size_t i = hash(rank) & mask;; i = (i + 1u) & mask) {
+      uint64_t current = _slots[i].load(std::memory_order_relaxed);
+
+      if (current == EMPTY &&
+          _slots[i].compare_exchange_strong(current,
+                                            rank,
+                                            std::memory_order_relaxed)) {
+        return true;
+      }
+
+      if (current == rank)
+        return false;
+    }
+  }
+
+private:
+  static std::size_t hash(uint64_t rank)
+  {
+    rank ^= rank >> 33u;
+    rank *= 0xff51afd7ed558ccdULL;
+    rank ^= rank >> 33u;
+
+    return static_cast<std::size_t>(rank);
+  }
+
+  std::size_t _capacity = 0u;
+  std::unique_ptr<std::atomic<uint64_t>[]> _slots;
+};
+
+constexpr uint64_t RankTable::EMPTY;
+
+// hash set split into independently locked shards
+template<typename KEY, typename HASH = std::hash<KEY>>
+class ShardedSet
+{
+  static constexpr unsigned NUM_SHARDS = 64u;
+
+public:
+  void reserve(std::size_t)
+  {}
+
+  bool insert(KEY const &key)
+  {
+    uint64_t h = HASH()(key);
+
+    auto &shard(_shards[(h * 0x9e3779b97f4a7c15ULL) >> 58u]);
+
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    return shard.keys.insert(key).second;
+  }
+
+private:
+  struct Shard
+  {
+    std::mutex mtx;
+    std::unordered_set<KEY, HASH> keys;
+  };
+
+  std::array<Shard, NUM_SHARDS> _shards;
+};
+
+rank_type to_rank(uint64_t key)
+{ return {key, 0u}; }
+
+rank_type to_rank(rank_type const &key)
+{ return key; }
+
+template<typename KEY>
+KEY from_rank(rank_type const &rank);
+
+template<>
+uint64_t from_rank<uint64_t>(rank_type const &rank)
+{ return rank.first; }
+
+template<>
+rank_type from_rank<rank_type>(rank_type const &rank)
+{ return rank; }
+
+// applies generators to ranks directly, without constructing task mappings
+class RankCodec
+{
+public:
+  RankCodec(TaskMappingRanking const &ranking, PermSet const &generators)
+  : _ranking(ranking)
+  {
+    unsigned radix = ranking.radix();
+
+    for (auto const &gen : generators) {
+      std::vector<unsigned> images(radix);
+
+      for (unsigned d = 0u; d < radix; ++d) {
+        unsigned task = ranking.task(d);
+
+        images[d] = task < gen.degree() ? ranking.digit(gen[task]) : d;
+      }
+
+      _images.push_back(images);
+    }
+
+    uint64_t factor = 1u;
+    for (unsigned i = 0u; i < ranking.num_digits(); ++i) {
+      if (i == ranking.num_digits_low())
+        factor = 1u;
+
+      _factors.push_back(factor);
+      factor *= radix;
+    }
+  }
+
+  template<typename KEY, typename FUNC>
+  void expand(KEY const &key, std::vector<unsigned> &digits, FUNC &&f) const
+  {
+    rank_type rank(to_rank(key));
+
+    unsigned radix = _ranking.radix();
+    unsigned num_digits = _ranking.num_digits();
+    unsigned num_digits_low = _ranking.num_digits_low();
+
+    digits.resize(num_digits);
+
+    for (unsigned i = 0u; i < num_digits; ++i) {
+      uint64_t &word = i < num_digits_low ? rank.first : rank.second;
+
+      digits[i] = static_cast<unsigned>(word % radix);
+      word /= radix;
+    }
+
+    for (auto const &images : _images) {
+      rank_type next {0u, 0u};
+
+      for (unsigned i = 0u; i < num_digits; ++i) {
+        uint64_t &word = i < num_digits_low ? next.first : next.second;
+
+        word += images[digits[i]] * _factors[i];
+      }
+
+      f(from_rank<KEY>(next));
+    }
+  }
+
+  template<typename KEY>
+  TaskMapping decode(KEY const &key) const
+  { return _ranking.unrank(to_rank(key)); }
+
+private:
+  TaskMappingRanking const &_ranking;
+
+  std::vector<std::vector<unsigned>> _images;
+  std::vector<uint64_t> _factors;
+};
+
+// fallback for mappings whose ranks do not fit into two words
+class MappingCodec
+{
+public:
+  MappingCodec(PermSet const &generators)
+  : _generators(generators)
+  {}
+
+  template<typename FUNC>
+  void expand(TaskMapping const &mapping,
+              std::vector<unsigned> &,
+              FUNC &&f) const
+  {
+    for (auto const &gen : _generators)
+      f(mapping.permuted(gen));
+  }
+
+  TaskMapping decode(TaskMapping const &mapping) const
+  { return mapping; }
+
+private:
+  PermSet const &_generators;
+};
+
+template<typename KEY, typename VISITED, typename CODEC>
+uint64_t bfs(KEY const &root,
+             std::size_t branching,
+             VISITED &visited,
+             CODEC const &codec,
+             ThreadPool &pool,
+             std::vector<TaskMapping> *mappings)
+{
+  std::vector<KEY> frontier {root};
+
+  visited.reserve(1u);
+  visited.insert(root);
+
+  uint64_t num_visited = 1u;
+
+  while (!frontier.empty()) {
+    if (mappings) {
+      for (KEY const &key : frontier)
+        mappings->push_back(codec.decode(key));
+    }
+
+    visited.reserve(num_visited + frontier.size() * branching);
+
+    // several chunks per thread to even out differing chunk workloads
+    std::size_t num_chunks =
+      std::min<std::size_t>(frontier.size(), pool.num_threads() * 8u);
+
+    std::vector<std::vector<KEY>> frontier_next(num_chunks);
+
+    pool.parallel_for(num_chunks, [&](std::size_t c){
+      std::size_t first = frontier.size() * c / num_chunks;
+      std::size_t last = frontier.size() * (c + 1u) / num_chunks;
+
+      std::vector<unsigned> digits;
+
+      for (std::size_t i = first; i < last; ++i) {
+        codec.expand(frontier[i], digits, [&](KEY const &key){
+          if (visited.insert(key))
+            frontier_next[c].push_back(key);
+        });
+      }
+    });
+
+    frontier.clear();
+
+    for (auto &chunk : frontier_next) {
+      frontier.insert(frontier.end(), chunk.begin(), chunk.end());
+      std::vector<KEY>().swap(chunk);
+    }
+
+    num_visited += frontier.size();
+  }
+
+  return num_visited;
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+TaskMappingRanking::TaskMappingRanking(TaskMapping const &root,
+                                       PermSet const &generators)
+: _num_digits(static_cast<unsigned>(root.size()))
+{
+  auto support(generators.support());
+
+  std::set<unsigned> support_set(support.begin(), support.end());
+  for (unsigned task : root)
+    support_set.insert(task);
+
+  _tasks.assign(support_set.begin(), support_set.end());
+
+  _digits.assign(_tasks.empty() ? 0u : _tasks.back() + 1u, UINT_MAX);
+  for (unsigned d = 0u; d < _tasks.size(); ++d)
+    _digits[_tasks[d]] = d;
+
+  // as many digits as possible are stored in the low word
+  uint64_t radix = _tasks.size();
+
+  auto fit = [&](unsigned first, uint64_t &num_ranks){
+    num_ranks = 1u;
+
+    unsigned i = first;
+    while (i < _num_digits && num_ranks <= UINT64_MAX / radix) {
+      num_ranks *= radix;
+      ++i;
+    }
+
+    return i;
+  };
+
+  _num_digits_low = fit(0u, _num_ranks);
+
+  if (_num_digits_low == _num_digits) {
+    _words = 1u;
+  } else {
+    uint64_t num_ranks_high;
+    _words = fit(_num_digits_low, num_ranks_high) == _num_digits ? 2u : 0u;
+  }
+}
+
+TaskMappingRanking::rank_type TaskMappingRanking::rank(
+  TaskMapping const &mapping) const
+{
+  assert(_words > 0u);
+  assert(mapping.size() == _num_digits);
+
+  rank_type res {0u, 0u};
+
+  uint64_t factor = 1u;
+  for (unsigned i = 0u; i < _num_digits; ++i) {
+    if (i == _num_digits_low)
+      factor = 1u;
+
+    assert(mapping[i] < _digits.size() && _digits[mapping[i]] != UINT_MAX);
+
+    uint64_t &word = i < _num_digits_low ? res.first : res.second;
+    word += _digits[mapping[i]] * factor;
+
+    factor *= radix();
+  }
+
+  return res;
+}
+
+TaskMapping TaskMappingRanking::unrank(rank_type const &rank) const
+{
+  assert(_words > 0u);
+
+  std::vector<unsigned> tasks(_num_digits);
+
+  rank_type rank_(rank);
+  for (unsigned i = 0u; i < _num_digits; ++i) {
+    uint64_t &word = i < _num_digits_low ? rank_.first : rank_.second;
+
+    tasks[i] = _tasks[word % radix()];
+    word /= radix();
+  }
+
+  return TaskMapping(tasks);
+}
+
+constexpr uint64_t TMOEnumerator::DEFAULT_MAX_BITMAP_BITS;
+
+TMOEnumerator::TMOEnumerator(TaskMapping const &root,
+                             PermSet const &generators,
+                             unsigned num_threads,
+                             uint64_t max_bitmap_bits)
+: _root(root),
+  _generators(generators),
+  _num_threads(num_threads),
+  _max_bitmap_bits(max_bitmap_bits)
+{}
+
+uint64_t TMOEnumerator::size() const
+{ return enumerate(nullptr); }
+
+std::vector<TaskMapping> TMOEnumerator::mappings() const
+{
+  std::vector<TaskMapping> res;
+  enumerate(&res);
+
+  return res;
+}
+
+uint64_t TMOEnumerator::enumerate(std::vector<TaskMapping> *mappings) const
+{
+  if (_generators.empty()) {
+    if (mappings)
+      mappings->push_back(_root);
+
+    return 1u;
+  }
+
+  TaskMappingRanking ranking(_root, _generators);
+
+  ThreadPool pool(_num_threads);
+
+  std::size_t branching = _generators.size();
+
+  switch (ranking.words()) {
+    case 1u:
+      {
+        RankCodec codec(ranking, _generators);
+
+        uint64_t root = ranking.rank(_root).first;
+
+        if (ranking.num_ranks() <= _max_bitmap_bits) {
+          AtomicBitmap visited(ranking.num_ranks());
+          return bfs(root, branching, visited, codec, pool, mappings);
+        }
+
+        RankTable visited;
+        return bfs(root, branching, visited, codec, pool, mappings);
+      }
+    case 2u:
+      {
+        RankCodec codec(ranking, _generators);
+
+        ShardedSet<rank_type, TaskMappingRanking::RankHash> visited;
+        return bfs(ranking.rank(_root), branching, visited, codec, pool, mappings);
+      }
+    default:
+      {
+        MappingCodec codec(_generators);
+
+        ShardedSet<TaskMapping> visited;
+        return bfs(_root, branching, visited, codec, pool, mappings);
+      }
+  }
+}
+
+} // namespace internal
+
+} // namespace mpsym
@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "task_mapping_store.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+constexpr unsigned TaskMappingStore::DEFAULT_NUM_SHARDS;
+constexpr unsigned TaskMappingStore::NO_WIDTH;
+
+// (unlinked) file in the spill directory shared by all arenas of a store,
+// arenas allocate page aligned regions at its end
+class TaskMappingStore::SpillFile
+{
+public:
+  explicit SpillFile(std::string const &spill_directory)
+  {
+    std::string file(spill_directory + "/mpsym-tmors-XXXXXX");
+
+    std::vector<char> file_template(file.begin(), file.end());
+    file_template.push_back('\0');
+
+    _fd = mkstemp(file_template.data());
+    if (_fd == -1)
+      throw std::runtime_error("failed to create spill file in " + spill_directory);
+
+    // the file is removed once it is closed
+    unlink(file_template.data());
+  }
+
+  ~SpillFile()
+  { close(_fd); }
+
+  int fd() const
+  { return _fd; }
+
+  static std::size_t region_bytes(std::size_t bytes)
+  {
+    static std::size_t const page_bytes = sysconf(_SC_PAGESIZE);
+
+    return (bytes + page_bytes - 1u) / page_bytes * page_bytes;
+  }
+
+  off_t allocate(std::size_t bytes)
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    off_t offs = _size;
+
+    if (ftruncate(_fd, offs + static_cast<off_t>(bytes)) == -1)
+      throw std::runtime_error("failed to grow spill file");
+
+    _size += static_cast<off_t>(bytes);
+
+    return offs;
+  }
+
+  // regions are never reused but their blocks can be freed
+  void release(off_t offs, std::size_t bytes)
+  {
+#ifdef FALLOC_FL_PUNCH_HOLE
+    fallocate(_fd,
+              FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+              offs,
+              static_cast<off_t>(bytes));
+#else
+    (void)offs;
+    (void)bytes;
+#endif
+  }
+
+private:
+  int _fd;
+  off_t _size = 0;
+
+  std::mutex _mtx;
+};
+
+// growable array of task mapping rows, either on the heap or mapped from a
+// region of the store's spill file
+class TaskMappingStore::Arena
+{
+public:
+  explicit Arena(std::shared_ptr<SpillFile> spill_file)
+  : _spill_file(spill_file)
+  {}
+
+  ~Arena()
+  {
+    if (_spill_file && _data)
+      munmap(_data, _capacity * sizeof(unsigned));
+  }
+
+  unsigned *data()
+  { return _data; }
+
+  unsigned const *data() const
+  { return _data; }
+
+  void reserve(std::size_t words)
+  {
+    if (words <= _capacity)
+      return;
+
+    std::size_t capacity = std::max({words, 2u * _capacity, MIN_CAPACITY});
+
+    if (!_spill_file) {
+      _heap.resize(capacity);
+      _data = _heap.data();
+
+    } else {
+      std::size_t bytes = SpillFile::region_bytes(capacity * sizeof(unsigned));
+
+      off_t offs = _spill_file->allocate(bytes);
+
+      // the old region stays mapped until its rows have been moved
+      void *addr = mmap(nullptr,
+                        bytes,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED,
+                        _spill_file->fd(),
+                        offs);
+
+      if (addr == MAP_FAILED) {
+        _spill_file->release(offs, bytes);
+        throw std::runtime_error("failed to map spill file");
+      }
+
+      if (_data) {
+        std::memcpy(addr, _data, _capacity * sizeof(unsigned));
+
+        munmap(_data, _capacity * sizeof(unsigned));
+        _spill_file->release(_offs, _capacity * sizeof(unsigned));
+      }
+
+      _data = static_cast<unsigned *>(addr);
+      _offs = offs;
+
+      capacity = bytes / sizeof(unsigned);
+    }
+
+    _capacity = capacity;
+  }
+
+private:
+  static constexpr std::size_t MIN_CAPACITY = 1024u;
+
+  std::shared_ptr<SpillFile> _spill_file;
+  off_t _offs = 0;
+
+  unsigned *_data = nullptr;
+  std::size_t _capacity = 0u;
+
+  std::vector<unsigned> _heap;
+};
+
+constexpr std::size_t TaskMappingStore::Arena::MIN_CAPACITY;
+
+TaskMappingStore::TaskMappingStore(std::string const &spill_directory,
+                                   unsigned num_shards)
+: _spill_directory(spill_directory),
+  _width(NO_WIDTH),
+  _size(0u)
+{
+  if (num_shards == 0u)
+    throw std::invalid_argument("number of shards must be positive");
+
+  if (!_spill_directory.empty())
+    _spill_file = std::make_shared<SpillFile>(_spill_directory);
+
+  for (unsigned i = 0u; i < num_shards; ++i) {
+    _shards.emplace_back(new Shard);
+    _shards.back()->rows.reset(new Arena(_spill_file));
+  }
+}
+
+TaskMappingStore::TaskMappingStore(TaskMappingStore const &other)
+: _spill_directory(other._spill_directory),
+  _width(other._width.load()),
+  _size(0u)
+{
+  if (!_spill_directory.empty())
+    _spill_file = std::make_shared<SpillFile>(_spill_directory);
+
+  for (auto const &other_shard : other._shards) {
+    std::lock_guard<std::mutex> lock(other_shard->mtx);
+
+    _shards.emplace_back(new Shard);
+
+    auto &shard(*_shards.back());
+    shard.rows.reset(new Arena(_spill_file));
+
+    if (other_shard->num_rows > 0u) {
+      std::size_t words =
+        static_cast<std::size_t>(other_shard->num_rows) * (_width + 1u);
+
+      shard.rows->reserve(words);
+
+      std::memcpy(shard.rows->data(),
+                  other_shard->rows->data(),
+                  words * sizeof(unsigned));
+    }
+
+    shard.num_rows = other_shard->num_rows;
+    shard.index = other_shard->index;
+
+    _size += shard.num_rows;
+  }
+}
+
+TaskMappingStore &TaskMappingStore::operator=(TaskMappingStore const &other)
+{
+  if (this != &other) {
+    TaskMappingStore tmp(other);
+
+    _spill_directory = std::move(tmp._spill_directory);
+    _spill_file = std::move(tmp._spill_file);
+    _shards = std::move(tmp._shards);
+    _width = tmp._width.load();
+    _size = tmp._size.load();
+  }
+
+  return *this;
+}
+
+TaskMappingStore::TaskMappingStore(TaskMappingStore &&other)
+: _spill_directory(std::move(other._spill_directory)),
+  _spill_file(std::move(other._spill_file)),
+  _shards(std::move(other._shards)),
+  _width(other._width.exchange(NO_WIDTH)),
+  _size(other._size.exchange(0u))
+{}
+
+TaskMappingStore &TaskMappingStore::operator=(TaskMappingStore &&other)
+{
+  if (this != &other) {
+    _spill_directory = std::move(other._spill_directory);
+    _spill_file = std::move(other._spill_file);
+    _shards = std::move(other._shards);
+    _width = other._width.exchange(NO_WIDTH);
+    _size = other._size.exchange(0u);
+  }
+
+  return *this;
+}
+
+TaskMappingStore::~TaskMappingStore() = default;
+
+std::pair<bool, unsigned> TaskMappingStore::insert(unsigned const *tasks,
+                                                   unsigned num_tasks)
+{
+  unsigned width = NO_WIDTH;
+  if (!_width.compare_exchange_strong(width, num_tasks))
+    width = _width.load();
+  else
+    width = num_tasks;
+
+  if (width != num_tasks)
+    throw std::invalid_argument("task mappings must all have the same length");
+
+  uint64_t h = hash(tasks, num_tasks);
+
+  auto &s(shard(h));
+
+  std::lock_guard<std::mutex> lock(s.mtx);
+
+  if (2u * (static_cast<std::size_t>(s.num_rows) + 1u) > s.index.size())
+    grow_index(s);
+
+  std::size_t slot;
+  if (find(s, h, tasks, num_tasks, slot))
+    return {false, row(s, s.index[slot] - 1u)[num_tasks]};
+
+  unsigned equivalence_class = _size++;
+
+  std::size_t row_words = num_tasks + 1u;
+
+  s.rows->reserve((static_cast<std::size_t>(s.num_rows) + 1u) * row_words);
+
+  unsigned *r = s.rows->data() + s.num_rows * row_words;
+  std::copy(tasks, tasks + num_tasks, r);
+  r[num_tasks] = equivalence_class;
+
+  s.index[slot] = ++s.num_rows;
+
+  return {true, equivalence_class};
+}
+
+bool TaskMappingStore::contains(unsigned const *tasks, unsigned num_tasks) const
+{
+  if (_width.load() != num_tasks)
+    return false;
+
+  uint64_t h = hash(tasks, num_tasks);
+
+  auto const &s(shard(h));
+
+  std::lock_guard<std::mutex> lock(s.mtx);
+
+  std::size_t slot;
+  return find(s, h, tasks, num_tasks, slot);
+}
+
+unsigned TaskMappingStore::num_rows(unsigned shard) const
+{ return _shards[shard]->num_rows; }
+
+unsigned const *TaskMappingStore::row(unsigned shard, unsigned i) const
+{ return row(*_shards[shard], i); }
+
+uint64_t TaskMappingStore::hash(unsigned const *tasks, unsigned num_tasks) const
+{
+  uint64_t h = 0xcbf29ce484222325ULL ^ num_tasks;
+
+  for (unsigned i = 0u; i < num_tasks; ++i) {
+    h ^= tasks[i];
+    h *= 0x100000001b3ULL;
+  }
+
+  // FNV-1a only propagates differences to higher bits, mix them back down
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  return h;
+}
+
+TaskMappingStore::Shard &TaskMappingStore::shard(uint64_t hash) const
+{ return *_shards[(hash >> 32) % _shards.size()]; }
+
+bool TaskMappingStore::find(Shard const &shard,
+                            uint64_t hash,
+                            unsigned const *tasks,
+                            unsigned num_tasks,
+                            std::size_t &slot) const
+{
+  if (shard.index.empty())
+    return false;
+
+  std::size_t mask = shard.index.size() - 1u;
+
+  for (slot = hash & mask;; slot = (slot + 1u) & mask) {
+    uint32_t i = shard.index[slot];
+
+    if (i == 0u)
+      return false;
+
+    if (std::equal(tasks, tasks + num_tasks, row(shard, i - 1u)))
+      return true;
+  }
+}
+
+void TaskMappingStore::grow_index(Shard &shard) const
+{
+  static constexpr std::size_t MIN_INDEX_SIZE = 16u;
+
+  std::size_t size = std::max(2u * shard.index.size(), MIN_INDEX_SIZE);
+  std::size_t mask = size - 1u;
+
+  std::vector<uint32_t> index(size, 0u);
+
+  unsigned width = _width.load();
+
+  for (unsigned i = 0u; i < shard.num_rows; ++i) {
+    std::size_t slot = hash(row(shard, i), width) & mask;
+
+    while (index[slot] != 0u)
+      slot = (slot + 1u) & mask;
+
+    index[slot] = i + 1u;
+  }
+
+  shard.index = std::move(index);
+}
+
+unsigned const *TaskMappingStore::row(Shard const &shard, unsigned i) const
+{
+  assert(i < shard.num_rows);
+
+  return shard.rows->data() + static_cast<std::size_t>(i) * (_width.load() + 1u);
+}
+
+} // namespace internal
+
+} // namespace mpsym
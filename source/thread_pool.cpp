@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+ThreadPool::ThreadPool(unsigned num_threads)
+: _task_next(0u)
+{
+  if (num_threads == 0u)
+    num_threads = default_num_threads();
+
+  // the calling thread also participates in every task
+  for (unsigned i = 1u; i < num_threads; ++i)
+    _workers.emplace_back(&ThreadPool::work, this, i - 1u);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _stop = true;
+  }
+
+  _cv_task.notify_all();
+
+  for (auto &worker : _workers)
+    worker.join();
+}
+
+unsigned ThreadPool::default_num_threads()
+{ return std::max(std::thread::hardware_concurrency(), 1u); }
+
+void ThreadPool::parallel_for(std::size_t n,
+                              task_type const &task,
+                              unsigned max_threads)
+{
+  unsigned num_workers = static_cast<unsigned>(_workers.size());
+
+  if (max_threads != 0u)
+    num_workers = std::min(num_workers, max_threads - 1u);
+
+  if (num_workers == 0u || n <= 1u) {
+    for (std::size_t i = 0u; i < n; ++i)
+      task(i);
+
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    _task = &task;
+    _task_size = n;
+    _task_next = 0u;
+    _task_num_workers = num_workers;
+    _task_pending = num_workers;
+    _task_exception = nullptr;
+
+    ++_task_generation;
+  }
+
+  _cv_task.notify_all();
+
+  run_task();
+
+  std::unique_lock<std::mutex> lock(_mtx);
+
+  _cv_done.wait(lock, [&]{ return _task_pending == 0u; });
+
+  _task = nullptr;
+
+  if (_task_exception)
+    std::rethrow_exception(_task_exception);
+}
+
+void ThreadPool::work(unsigned index)
+{
+  unsigned long generation = 0u;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(_mtx);
+
+      _cv_task.wait(lock, [&]{
+        return _stop || _task_generation != generation;
+      });
+
+      if (_stop)
+        return;
+
+      generation = _task_generation;
+
+      // only the first _task_num_workers workers take part in a task
+      if (index >= _task_num_workers)
+        continue;
+    }
+
+    run_task();
+
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+
+      if (--_task_pending == 0u)
+        _cv_done.notify_one();
+    }
+  }
+}
+
+void ThreadPool::run_task()
+{
+  for (;;) {
+    std::size_t i = _task_next++;
+    if (i >= _task_size)
+      return;
+
+    try {
+      (*_task)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(_mtx);
+
+      if (!_task_exception)
+        _task_exception = std::current_exception();
+
+      // skip all remaining iterations
+      _task_next = _task_size;
+    }
+  }
+}
+
+void SharedThreadPool::Lease::parallel_for(
+  std::size_t n,
+  ThreadPool::task_type const &task) const
+{
+  if (_pool) {
+    _pool->parallel_for(n, task, _num_threads);
+  } else {
+    for (std::size_t i = 0u; i < n; ++i)
+      task(i);
+  }
+}
+
+SharedThreadPool::Lease SharedThreadPool::lease(unsigned num_threads)
+{
+  if (num_threads == 0u)
+    num_threads = ThreadPool::default_num_threads();
+
+  std::unique_lock<std::mutex> lock(_mtx, std::try_to_lock);
+
+  if (!lock.owns_lock())
+    return Lease(std::move(lock), nullptr, num_threads);
+
+  if (!_pool || _pool->num_threads() < num_threads) {
+    _pool.reset(new ThreadPool(
+      std::max(num_threads, ThreadPool::default_num_threads())));
+  }
+
+  return Lease(std::move(lock), _pool.get(), num_threads);
+}
+
+} // namespace internal
+
+} // namespace mpsym
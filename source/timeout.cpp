@@ -3,6 +3,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace mpsym
 {
@@ -17,6 +18,76 @@ std::atomic<int> _timeout_thread_count(0);
 std::condition_variable _timeout_thread_count_cv;
 std::mutex _timeout_thread_count_mtx;
 
+Watchdog &Watchdog::instance()
+{
+  static Watchdog watchdog;
+  return watchdog;
+}
+
+Watchdog::~Watchdog()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _stop = true;
+  }
+
+  _cv.notify_one();
+
+  if (_thread.joinable())
+    _thread.join();
+}
+
+Watchdog::deadline_type Watchdog::arm(clock::time_point deadline,
+                                      flag const &f)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  // started lazily, waits for the lock before it accesses any deadlines
+  if (!_thread.joinable())
+    _thread = std::thread(&Watchdog::watch, this);
+
+  deadline_type res(deadline, _next_id++);
+
+  bool earliest = _deadlines.empty() || res < _deadlines.begin()->first;
+
+  _deadlines.emplace(res, f);
+
+  if (earliest)
+    _cv.notify_one();
+
+  return res;
+}
+
+void Watchdog::disarm(deadline_type const &deadline)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  _deadlines.erase(deadline);
+}
+
+void Watchdog::watch()
+{
+  std::unique_lock<std::mutex> lock(_mtx);
+
+  while (!_stop) {
+    if (_deadlines.empty()) {
+      _cv.wait(lock);
+      continue;
+    }
+
+    auto it(_deadlines.begin());
+
+    if (clock::now() < it->first.first) {
+      _cv.wait_until(lock, it->first.first);
+      continue;
+    }
+
+    set(it->second);
+
+    _deadlines.erase(it);
+  }
+}
+
 } // namespace timeout
 
 } // namespace internal
@@ -1,6 +1,10 @@
 #include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -8,12 +12,15 @@
 #include "gmock/gmock.h"
 
 #include "arch_graph.hpp"
+#include "arch_graph_automorphisms.hpp"
 #include "arch_graph_cluster.hpp"
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
+#include "task_mapping_orbit.hpp"
 #include "test_utility.hpp"
 
 #include "test_main.cpp"
@@ -318,6 +325,245 @@ TEST_F(ArchGraphTest, CanObtainAutomorphisms)
     << "Automorphisms of minimal triangular architecture graph correct.";
 }
 
+TEST_F(ArchGraphTest, CanObtainAutomorphismsOfRing)
+{
+  ArchGraph::clear_automorphisms_nauty_cache();
+
+  ArchGraph ag;
+
+  auto p = ag.new_processor_type("P");
+  auto c = ag.new_channel_type("C");
+
+  std::vector<unsigned> pes;
+  for (unsigned i = 0u; i < 6u; ++i)
+    pes.push_back(ag.add_processor(p));
+
+  for (unsigned i = 0u; i < 6u; ++i)
+    ag.add_channel(pes[i], pes[(i + 1u) % 6u], c);
+
+  EXPECT_EQ(12u, ag.num_automorphisms())
+    << "Number of automorphisms of ring architecture graph correct.";
+
+  ArchGraph::clear_automorphisms_nauty_cache();
+}
+
+TEST_F(ArchGraphTest, CanCacheAutomorphisms)
+{
+  ArchGraphSystem::set_automorphisms_cache_dir(testing::TempDir());
+
+  auto ag(ag_nocol());
+  auto automorphisms(ag.automorphisms());
+
+  auto cache_file(ag.automorphisms_cache_file());
+
+  EXPECT_TRUE(std::ifstream(cache_file).good())
+    << "Automorphisms cache file created.";
+
+  auto ag_cached(ag_nocol());
+
+  EXPECT_EQ(cache_file, ag_cached.automorphisms_cache_file())
+    << "Automorphisms cache file name deterministic.";
+
+  EXPECT_EQ(automorphisms, ag_cached.automorphisms())
+    << "Automorphisms correctly loaded from cache.";
+
+  EXPECT_NE(cache_file, ag_vcol().automorphisms_cache_file())
+    << "Automorphisms cache file name depends on architecture graph.";
+
+  // simulate a hash collision
+  auto ag_vcol_(ag_vcol());
+  ag_vcol_.automorphisms().bsgs().save(cache_file, ag_vcol_.to_json());
+
+  EXPECT_EQ(automorphisms, ag_nocol().automorphisms())
+    << "Automorphisms of different architecture graph not loaded from cache.";
+
+  std::remove(cache_file.c_str());
+
+  ArchGraphSystem::set_automorphisms_cache_dir("");
+}
+
+TEST_F(ArchGraphTest, CanCacheAutomorphismsOfIsomorphicGraphs)
+{
+  ArchGraph::clear_automorphisms_nauty_cache();
+
+  ag_vcol().automorphisms();
+
+  EXPECT_EQ(0u, ArchGraph::automorphisms_nauty_cache_hits())
+    << "Automorphisms of new architecture graph not loaded from cache.";
+
+  /*
+   * 1 -- 1 -- 3  P1 -- C -- P2
+   * |         |  |          |
+   * 4         2  C          C
+   * |         |  |          |
+   * 4 -- 3 -- 2  P2 -- C -- P1
+   */
+  ArchGraph ag;
+
+  auto p1 = ag.new_processor_type("P1");
+  auto p2 = ag.new_processor_type("P2");
+  auto c = ag.new_channel_type("C");
+
+  auto pe1 = ag.add_processor(p1);
+  auto pe2 = ag.add_processor(p1);
+  auto pe3 = ag.add_processor(p2);
+  auto pe4 = ag.add_processor(p2);
+
+  ag.add_channel(pe1, pe3, c);
+  ag.add_channel(pe3, pe2, c);
+  ag.add_channel(pe2, pe4, c);
+  ag.add_channel(pe4, pe1, c);
+
+  EXPECT_TRUE(perm_group_equal({
+      Perm(4, {{0, 1}, {2, 3}}),
+      Perm(4, {{0, 1}}),
+      Perm(4, {{2, 3}})
+    }, ag.automorphisms()))
+    << "Automorphisms of isomorphic architecture graph correct.";
+
+  EXPECT_EQ(1u, ArchGraph::automorphisms_nauty_cache_hits())
+    << "Automorphisms of isomorphic architecture graph loaded from cache.";
+
+  ArchGraph::clear_automorphisms_nauty_cache();
+}
+
+TEST_F(ArchGraphTest, CanDetermineExactReprViaIteration)
+{
+  PermGroup automorphisms(
+    PermGroup::wreath_product(PermGroup::symmetric(4), PermGroup::cyclic(3)));
+
+  ArchGraphAutomorphisms aga(automorphisms);
+
+  ReprOptions options_iterate;
+  options_iterate.method = ReprOptions::Method::ITERATE;
+
+  for (unsigned i = 0u; i < 12u; ++i) {
+    for (unsigned j = 0u; j < 12u; j += 5u) {
+      TaskMapping mapping({i, j, (i + j) % 12u, 11u - i, j});
+
+      TaskMapping expected(mapping);
+      for (Perm const &perm : automorphisms) {
+        TaskMapping permuted(mapping.permuted(perm));
+        if (permuted.less_than(expected))
+          expected = permuted;
+      }
+
+      EXPECT_EQ(expected, aga.repr(mapping, &options_iterate))
+        << "Iteration yields minimal representative of " << mapping;
+    }
+  }
+}
+
+TEST_F(ArchGraphTest, CanDetermineExactReprViaBacktracking)
+{
+  ArchGraphAutomorphisms aga(
+    PermGroup::wreath_product(PermGroup::dihedral(4), PermGroup::cyclic(3)));
+
+  ReprOptions options_iterate;
+  options_iterate.method = ReprOptions::Method::ITERATE;
+
+  ReprOptions options_backtrack;
+  options_backtrack.method = ReprOptions::Method::BACKTRACK;
+
+  for (unsigned i = 0u; i < 12u; ++i) {
+    for (unsigned j = 0u; j < 12u; ++j) {
+      for (unsigned k = 0u; k < 12u; ++k) {
+        TaskMapping mapping({i, j, k, i});
+
+        EXPECT_EQ(aga.repr(mapping, &options_iterate),
+                  aga.repr(mapping, &options_backtrack))
+          << "Backtracking yields minimal representative of " << mapping;
+      }
+    }
+  }
+}
+
+TEST_F(ArchGraphTest, CanDetermineExactReprViaStabilizerChain)
+{
+  ArchGraphAutomorphisms aga(
+    PermGroup::wreath_product(PermGroup::dihedral(4), PermGroup::cyclic(3)));
+
+  ReprOptions options_iterate;
+  options_iterate.method = ReprOptions::Method::ITERATE;
+
+  ReprOptions options_stabilizer_chain;
+  options_stabilizer_chain.method = ReprOptions::Method::STABILIZER_CHAIN;
+
+  for (unsigned i = 0u; i < 12u; ++i) {
+    for (unsigned j = 0u; j < 12u; ++j) {
+      for (unsigned k = 0u; k < 12u; ++k) {
+        TaskMapping mapping({i, j, k, i});
+
+        EXPECT_EQ(aga.repr(mapping, &options_iterate),
+                  aga.repr(mapping, &options_stabilizer_chain))
+          << "Stabilizer chain yields minimal representative of " << mapping;
+      }
+    }
+  }
+
+  // automorphisms fixing most processors
+  PermGroup automorphisms_sparse(16u, {Perm(16u, {{1, 2, 3, 4}}),
+                                       Perm(16u, {{1, 5}, {2, 6}, {3, 7}, {4, 8}})});
+
+  ArchGraphAutomorphisms aga_sparse(automorphisms_sparse);
+
+  for (unsigned i = 0u; i < 16u; ++i) {
+    for (unsigned j = 0u; j < 16u; j += 3u) {
+      TaskMapping mapping({15u - i, i, j, 0u, (i * j) % 16u});
+
+      TaskMapping expected(mapping);
+      for (Perm const &perm : automorphisms_sparse) {
+        TaskMapping permuted(mapping.permuted(perm));
+        if (permuted.less_than(expected))
+          expected = permuted;
+      }
+
+      EXPECT_EQ(expected, aga_sparse.repr(mapping, &options_stabilizer_chain))
+        << "Stabilizer chain yields minimal representative of " << mapping;
+    }
+  }
+}
+
+TEST_F(ArchGraphTest, CanDetermineReprViaMultiStartLocalSearch)
+{
+  ArchGraphAutomorphisms aga(
+    PermGroup::wreath_product(PermGroup::dihedral(4), PermGroup::cyclic(3)));
+
+  ReprOptions options_iterate;
+  options_iterate.method = ReprOptions::Method::ITERATE;
+
+  ReprOptions options_local_search;
+  options_local_search.method = ReprOptions::Method::LOCAL_SEARCH;
+
+  ReprOptions options_multi_start(options_local_search);
+  options_multi_start.variant = ReprOptions::Variant::LOCAL_SEARCH_MULTI_START;
+  options_multi_start.local_search_multi_start_num_threads = 4u;
+
+  for (unsigned i = 0u; i < 12u; ++i) {
+    for (unsigned j = 0u; j < 12u; ++j) {
+      TaskMapping mapping({i, j, 11u - i, j});
+
+      auto repr_exact(aga.repr(mapping, &options_iterate));
+      auto repr_local_search(aga.repr(mapping, &options_local_search));
+      auto repr_multi_start(aga.repr(mapping, &options_multi_start));
+
+      EXPECT_EQ(repr_exact, aga.repr(repr_multi_start, &options_iterate))
+        << "Multi start local search yields orbit element of " << mapping;
+
+      EXPECT_FALSE(repr_local_search.less_than(repr_multi_start))
+        << "Multi start local search improves on local search for " << mapping;
+
+      // the first climber always encounters the local search representative
+      TMORs orbits;
+      orbits.insert(repr_local_search);
+
+      EXPECT_EQ(repr_local_search,
+                std::get<0>(aga.repr(mapping, orbits, &options_multi_start)))
+        << "Multi start local search matches known representative of " << mapping;
+    }
+  }
+}
+
 class ArchGraphReprVariantTest :
   public ArchGraphTestBase<testing::TestWithParam<ReprOptions::Method>>
 {};
@@ -372,7 +618,9 @@ INSTANTIATE_TEST_SUITE_P(
   ArchGraphReprVariantTest,
   testing::Values(ReprOptions::Method::ITERATE,
                   ReprOptions::Method::LOCAL_SEARCH,
-                  ReprOptions::Method::ORBITS));
+                  ReprOptions::Method::ORBITS,
+                  ReprOptions::Method::BACKTRACK,
+                  ReprOptions::Method::STABILIZER_CHAIN));
 
 template<typename T>
 class ArchGraphClusterTestBase : public T
@@ -440,6 +688,45 @@ TEST_F(ArchGraphClusterTest, CanObtainAutormorphisms)
     << "Automorphisms of minimal architecture graph cluster correct.";
 }
 
+TEST_F(ArchGraphClusterTest, CanDetermineReprInParallel)
+{
+  auto ag(std::make_shared<ArchGraph>());
+
+  auto p = ag->new_processor_type("P");
+  auto c = ag->new_channel_type("C");
+
+  auto pe1 = ag->add_processor(p);
+  auto pe2 = ag->add_processor(p);
+  auto pe3 = ag->add_processor(p);
+
+  ag->add_channel(pe1, pe2, c);
+  ag->add_channel(pe2, pe3, c);
+  ag->add_channel(pe3, pe1, c);
+
+  cluster_minimal->add_subsystem(ag);
+
+  unsigned n = cluster_minimal->num_processors();
+
+  for (auto method : {ReprOptions::Method::ITERATE,
+                      ReprOptions::Method::LOCAL_SEARCH,
+                      ReprOptions::Method::BACKTRACK,
+                      ReprOptions::Method::STABILIZER_CHAIN}) {
+    ReprOptions options;
+    options.method = method;
+
+    ReprOptions options_parallel(options);
+    options_parallel.cluster_num_threads = 4u;
+
+    for (unsigned i = 0u; i < n * n * n; ++i) {
+      TaskMapping mapping({i % n, (i / n) % n, i / (n * n)});
+
+      EXPECT_EQ(cluster_minimal->repr(mapping, &options),
+                cluster_minimal->repr(mapping, &options_parallel))
+        << "Parallel representative of cluster correct.";
+    }
+  }
+}
+
 class ArchGraphClusterReprVariantTest :
   public ArchGraphClusterTestBase<testing::TestWithParam<ReprOptions::Method>>
 {};
@@ -468,7 +755,9 @@ INSTANTIATE_TEST_SUITE_P(
   ArchGraphClusterReprVariantTest,
   testing::Values(ReprOptions::Method::ITERATE,
                   ReprOptions::Method::LOCAL_SEARCH,
-                  ReprOptions::Method::ORBITS));
+                  ReprOptions::Method::ORBITS,
+                  ReprOptions::Method::BACKTRACK,
+                  ReprOptions::Method::STABILIZER_CHAIN));
 
 template<typename T>
 class ArchUniformSuperGraphTestBase : public T
@@ -552,3 +841,272 @@ TEST_F(ArchUniformSuperGraphTest, CanObtainAutormorphisms)
   EXPECT_EQ(expected_automorphisms, super_graph_minimal->automorphisms())
     << "Automorphisms of uniform architecture super_graph correct.";
 }
+
+TEST_F(ArchUniformSuperGraphTest, CanDetermineExactRepr)
+{
+  ArchGraphAutomorphisms flat(super_graph_minimal->automorphisms());
+
+  unsigned n = super_graph_minimal->num_processors();
+
+  for (auto method : {ReprOptions::Method::ITERATE,
+                      ReprOptions::Method::BACKTRACK,
+                      ReprOptions::Method::STABILIZER_CHAIN}) {
+    ReprOptions options;
+    options.method = method;
+
+    for (unsigned i = 0u; i < n * n * n; ++i) {
+      TaskMapping mapping({i % n, (i / n) % n, i / (n * n)});
+
+      EXPECT_EQ(flat.repr(mapping, &options),
+                super_graph_minimal->repr(mapping, &options))
+        << "Representative of uniform architecture super_graph is minimal.";
+    }
+  }
+}
+
+TEST_F(ArchUniformSuperGraphTest, CanComputeReprBatch)
+{
+  std::vector<TaskMapping> mappings;
+  for (auto i = 0u; i < super_graph_minimal->num_processors(); ++i) {
+    for (auto j = 0u; j < super_graph_minimal->num_processors(); ++j)
+      mappings.push_back(TaskMapping({i, j}));
+  }
+
+  TMORs expected_orbits;
+  std::vector<TaskMapping> expected_reprs;
+
+  for (auto const &mapping : mappings)
+    expected_reprs.push_back(std::get<0>(super_graph_minimal->repr(mapping, expected_orbits)));
+
+  for (unsigned num_threads : {1u, 4u}) {
+    std::vector<TaskMapping> reprs(mappings.size());
+
+    super_graph_minimal->repr_batch(mappings.data(),
+                                    mappings.size(),
+                                    reprs.data(),
+                                    nullptr,
+                                    num_threads);
+
+    EXPECT_EQ(expected_reprs, reprs)
+      << "Batched representatives correct (" << num_threads << " threads).";
+
+    TMORs orbits;
+    std::vector<TaskMapping> orbit_reprs(mappings.size());
+    std::vector<unsigned> orbit_indices(mappings.size());
+
+    super_graph_minimal->repr_batch(mappings.data(),
+                                    mappings.size(),
+                                    orbit_reprs.data(),
+                                    orbits,
+                                    orbit_indices.data(),
+                                    nullptr,
+                                    num_threads);
+
+    EXPECT_EQ(expected_orbits, orbits)
+      << "Batched orbit representatives correct (" << num_threads << " threads).";
+
+    std::unordered_map<TaskMapping, unsigned> orbit_index_map;
+    for (auto i = 0u; i < mappings.size(); ++i) {
+      auto it(orbit_index_map.find(orbit_reprs[i]));
+
+      if (it == orbit_index_map.end())
+        orbit_index_map[orbit_reprs[i]] = orbit_indices[i];
+      else
+        EXPECT_EQ(it->second, orbit_indices[i])
+          << "Batched orbit indices consistent (" << num_threads << " threads).";
+    }
+
+    EXPECT_EQ(orbits.num_orbits(), orbit_index_map.size())
+      << "Batched orbit indices distinct (" << num_threads << " threads).";
+
+    std::vector<unsigned> mappings_flat, reprs_flat(2u * mappings.size());
+    for (auto const &mapping : mappings)
+      mappings_flat.insert(mappings_flat.end(), mapping.begin(), mapping.end());
+
+    TMORs orbits_flat;
+    std::vector<unsigned> orbit_indices_flat(mappings.size());
+
+    super_graph_minimal->repr_batch_flat(mappings_flat.data(),
+                                         mappings.size(),
+                                         2u,
+                                         reprs_flat.data(),
+                                         &orbits_flat,
+                                         orbit_indices_flat.data(),
+                                         nullptr,
+                                         num_threads);
+
+    for (auto i = 0u; i < mappings.size(); ++i) {
+      EXPECT_EQ(expected_reprs[i],
+                TaskMapping({reprs_flat[2u * i], reprs_flat[2u * i + 1u]}))
+        << "Flat batched representatives correct (" << num_threads << " threads).";
+    }
+
+    EXPECT_EQ(expected_orbits, orbits_flat)
+      << "Flat batched orbit representatives correct (" << num_threads << " threads).";
+
+    std::string file(testing::TempDir() + "repr_batch_test.tmf");
+    TaskMappingView::save(file, mappings.data(), mappings.size());
+
+    TaskMappingView mappings_view(file);
+
+    std::vector<TaskMapping> reprs_view(mappings.size());
+    TMORs orbits_view;
+
+    super_graph_minimal->repr_batch(mappings_view,
+                                    reprs_view.data(),
+                                    &orbits_view,
+                                    nullptr,
+                                    nullptr,
+                                    num_threads);
+
+    EXPECT_EQ(expected_reprs, reprs_view)
+      << "Memory mapped batched representatives correct (" << num_threads << " threads).";
+
+    EXPECT_EQ(expected_orbits, orbits_view)
+      << "Memory mapped batched orbit representatives correct (" << num_threads << " threads).";
+  }
+
+  // concurrent batches on a system whose representative computation has not
+  // been initialized yet
+  auto super_graph_fresh(std::make_shared<ArchUniformSuperGraph>(
+    std::make_shared<ArchGraph>(
+      *std::dynamic_pointer_cast<ArchGraph>(super_graph_minimal->super_graph())),
+    std::make_shared<ArchGraph>(
+      *std::dynamic_pointer_cast<ArchGraph>(super_graph_minimal->proto()))));
+
+  super_graph_fresh->reset_repr();
+
+  ReprOptions options_backtrack;
+  options_backtrack.method = ReprOptions::Method::BACKTRACK;
+
+  std::vector<std::vector<TaskMapping>> reprs_concurrent(
+    4u, std::vector<TaskMapping>(mappings.size()));
+
+  std::vector<std::thread> batches;
+
+  for (auto &reprs : reprs_concurrent) {
+    batches.emplace_back([&]{
+      super_graph_fresh->repr_batch(mappings.data(),
+                                    mappings.size(),
+                                    reprs.data(),
+                                    &options_backtrack,
+                                    2u);
+    });
+  }
+
+  for (auto &batch : batches)
+    batch.join();
+
+  for (auto const &reprs : reprs_concurrent) {
+    EXPECT_EQ(expected_reprs, reprs)
+      << "Concurrently batched representatives correct.";
+  }
+}
+
+TEST_F(ArchUniformSuperGraphTest, CanMemoizeRepr)
+{
+  std::vector<TaskMapping> mappings;
+  for (auto i = 0u; i < super_graph_minimal->num_processors(); ++i) {
+    for (auto j = 0u; j < super_graph_minimal->num_processors(); ++j)
+      mappings.push_back(TaskMapping({i, j}));
+  }
+
+  TMORs expected_orbits;
+  std::vector<TaskMapping> expected_reprs;
+
+  for (auto const &mapping : mappings)
+    expected_reprs.push_back(std::get<0>(super_graph_minimal->repr(mapping, expected_orbits)));
+
+  for (std::size_t memo_capacity : {8u, 1000u}) {
+    TMORs orbits;
+    orbits.set_memo_capacity(memo_capacity);
+
+    std::vector<unsigned> orbit_indices(mappings.size());
+
+    for (unsigned pass = 0u; pass < 2u; ++pass) {
+      for (auto i = 0u; i < mappings.size(); ++i) {
+        auto res(super_graph_minimal->repr(mappings[i], orbits));
+
+        EXPECT_EQ(expected_reprs[i], std::get<0>(res))
+          << "Memoized representative correct (memo capacity " << memo_capacity << ").";
+
+        if (pass == 0u)
+          orbit_indices[i] = std::get<2>(res);
+        else
+          EXPECT_TRUE(!std::get<1>(res) && std::get<2>(res) == orbit_indices[i])
+            << "Memoized orbit index correct (memo capacity " << memo_capacity << ").";
+      }
+    }
+
+    EXPECT_EQ(expected_orbits, orbits)
+      << "Memoized orbit representatives correct (memo capacity " << memo_capacity << ").";
+
+    auto stats(orbits.memo_stats());
+
+    EXPECT_EQ(2u * mappings.size(), stats.hits + stats.misses)
+      << "Memo lookups counted (memo capacity " << memo_capacity << ").";
+
+    if (memo_capacity >= mappings.size()) {
+      EXPECT_TRUE(stats.hits == mappings.size() && stats.evictions == 0u)
+        << "Memo hit for all previously seen mappings.";
+    } else {
+      EXPECT_GT(stats.evictions, 0u)
+        << "Memo evicts mappings once full.";
+    }
+
+    std::vector<TaskMapping> reprs(mappings.size());
+
+    super_graph_minimal->repr_batch(mappings.data(),
+                                    mappings.size(),
+                                    reprs.data(),
+                                    orbits,
+                                    nullptr,
+                                    nullptr,
+                                    4u);
+
+    EXPECT_EQ(expected_reprs, reprs)
+      << "Memoized batched representatives correct (memo capacity " << memo_capacity << ").";
+  }
+
+  TMORs orbits;
+  orbits.set_memo_capacity(1000u);
+
+  for (auto const &mapping : mappings)
+    super_graph_minimal->repr(mapping, orbits);
+
+  ReprOptions options_offset;
+  options_offset.offset = 1u;
+
+  for (auto i = 0u; i < mappings.size(); ++i) {
+    TaskMapping mapping_offset(mappings[i]);
+    TaskMapping expected_repr_offset(expected_reprs[i]);
+
+    for (auto j = 0u; j < mapping_offset.size(); ++j) {
+      ++mapping_offset[j];
+      ++expected_repr_offset[j];
+    }
+
+    EXPECT_EQ(expected_repr_offset,
+              std::get<0>(super_graph_minimal->repr(mapping_offset, orbits, &options_offset)))
+      << "Memoized representative correct for different offset.";
+  }
+
+  ReprOptions options_no_match;
+  options_no_match.match = false;
+
+  auto misses(orbits.memo_stats().misses);
+
+  super_graph_minimal->repr(mappings[0], orbits, &options_no_match);
+
+  EXPECT_EQ(misses + 1u, orbits.memo_stats().misses)
+    << "Representatives not memoized across options affecting them.";
+
+  ReprOptions options_sa;
+  options_sa.match = false;
+  options_sa.local_search_sa_iterations = 10u;
+
+  super_graph_minimal->repr(mappings[0], orbits, &options_sa);
+
+  EXPECT_EQ(misses + 1u, orbits.memo_stats().misses)
+    << "Representatives memoized across options not affecting them.";
+}
@@ -1,9 +1,18 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "gmock/gmock.h"
 
 #include "bsgs.hpp"
+#include "cached_transversals.hpp"
+#include "orbit.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
@@ -47,6 +56,415 @@ TEST(DISABLED_BSGSSolveTest, CanSolveBSGS)
       << "Solving BSGS fails for non-solvable group generating set.";
 }
 
+TEST(BSGSStripTest, CanStripElements)
+{
+  PermSet generators {
+    Perm(6, {{0, 1, 2, 3}}),
+    Perm(6, {{0, 1}})
+  };
+
+  for (auto transversals : {BSGSOptions::Transversals::EXPLICIT,
+                            BSGSOptions::Transversals::SCHREIER_TREES,
+                            BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES,
+                            BSGSOptions::Transversals::CACHED}) {
+    BSGSOptions bsgs_options;
+    bsgs_options.transversals = transversals;
+
+    BSGS bsgs(generators, &bsgs_options);
+
+    Perm member(6, {{0, 2}, {1, 3}});
+
+    EXPECT_TRUE(bsgs.strips_completely(member))
+      << "Group element strips completely.";
+
+    auto member_strip(bsgs.strip(member));
+
+    EXPECT_TRUE(member_strip.first.id() &&
+                member_strip.second == bsgs.base_size() + 1u)
+      << "Group element strips to identity.";
+
+    // does not fix the first base point
+    Perm non_member_orbit(6, {{0, 4}});
+
+    EXPECT_FALSE(bsgs.strips_completely(non_member_orbit))
+      << "Element moving base point out of its orbit does not strip completely.";
+
+    auto non_member_orbit_strip(bsgs.strip(non_member_orbit));
+
+    EXPECT_TRUE(non_member_orbit_strip.first == non_member_orbit &&
+                non_member_orbit_strip.second == 1u)
+      << "Element moving base point out of its orbit strips correctly.";
+
+    // fixes all base points
+    Perm non_member_fixed(6, {{4, 5}});
+
+    EXPECT_FALSE(bsgs.strips_completely(non_member_fixed))
+      << "Element fixing all base points does not strip completely.";
+
+    auto non_member_fixed_strip(bsgs.strip(non_member_fixed));
+
+    EXPECT_TRUE(non_member_fixed_strip.first == non_member_fixed &&
+                non_member_fixed_strip.second == bsgs.base_size() + 1u)
+      << "Element fixing all base points strips correctly.";
+  }
+}
+
+TEST(BSGSSchreierSimsParallelTest, ParallelSchreierSimsMatchesSerial)
+{
+  PermSet generators {
+    Perm(12, {{0, 1, 2, 3}}),
+    Perm(12, {{4, 5}, {6, 7}}),
+    Perm(12, {{0, 4, 8}, {1, 5, 9}, {2, 6, 10}, {3, 7, 11}}),
+    Perm(12, {{8, 9, 10}})
+  };
+
+  BSGSOptions bsgs_options_serial;
+  bsgs_options_serial.construction = BSGSOptions::Construction::SCHREIER_SIMS;
+  bsgs_options_serial.check_sym = false;
+  bsgs_options_serial.reduce_gens = false;
+
+  BSGS bsgs_serial(generators, &bsgs_options_serial);
+
+  for (unsigned num_threads : {1u, 4u}) {
+    for (unsigned batch_size : {1u, 3u, 64u}) {
+      BSGSOptions bsgs_options_parallel(bsgs_options_serial);
+      bsgs_options_parallel.construction =
+        BSGSOptions::Construction::SCHREIER_SIMS_PARALLEL;
+      bsgs_options_parallel.schreier_sims_parallel_num_threads = num_threads;
+      bsgs_options_parallel.schreier_sims_parallel_batch_size = batch_size;
+
+      BSGS bsgs_parallel(generators, &bsgs_options_parallel);
+
+      EXPECT_EQ(bsgs_serial.base(), bsgs_parallel.base())
+        << "Parallel Schreier Sims produces same base as serial algorithm.";
+
+      PermSet strong_generators_serial(bsgs_serial.strong_generators());
+      PermSet strong_generators_parallel(bsgs_parallel.strong_generators());
+
+      EXPECT_EQ(std::vector<Perm>(strong_generators_serial.begin(),
+                                  strong_generators_serial.end()),
+                std::vector<Perm>(strong_generators_parallel.begin(),
+                                  strong_generators_parallel.end()))
+        << "Parallel Schreier Sims produces same strong generators as serial algorithm.";
+    }
+  }
+}
+
+TEST(BSGSSchreierSimsRandomTest, CanConstructBSGSFromParallelRandomStreams)
+{
+  PermSet generators {
+    Perm(12, {{0, 1, 2, 3}}),
+    Perm(12, {{4, 5}, {6, 7}}),
+    Perm(12, {{0, 4, 8}, {1, 5, 9}, {2, 6, 10}, {3, 7, 11}}),
+    Perm(12, {{8, 9, 10}})
+  };
+
+  BSGSOptions bsgs_options_deterministic;
+  bsgs_options_deterministic.construction = BSGSOptions::Construction::SCHREIER_SIMS;
+  bsgs_options_deterministic.check_sym = false;
+
+  BSGS bsgs_deterministic(generators, &bsgs_options_deterministic);
+
+  for (unsigned num_threads : {1u, 4u}) {
+    BSGSOptions bsgs_options_random(bsgs_options_deterministic);
+    bsgs_options_random.construction = BSGSOptions::Construction::SCHREIER_SIMS_RANDOM;
+    bsgs_options_random.schreier_sims_random_seed = 42;
+    bsgs_options_random.schreier_sims_random_num_threads = num_threads;
+
+    BSGS bsgs_random(generators, &bsgs_options_random);
+
+    EXPECT_EQ(bsgs_deterministic.order(), bsgs_random.order())
+      << "Random Schreier Sims produces correct BSGS ("
+      << num_threads << " threads).";
+
+    // without verification, the result only depends on the seed
+    bsgs_options_random.schreier_sims_random_guarantee = false;
+
+    BSGS bsgs_random_seeded1(generators, &bsgs_options_random);
+    BSGS bsgs_random_seeded2(generators, &bsgs_options_random);
+
+    PermSet strong_generators1(bsgs_random_seeded1.strong_generators());
+    PermSet strong_generators2(bsgs_random_seeded2.strong_generators());
+
+    EXPECT_TRUE(bsgs_random_seeded1.base() == bsgs_random_seeded2.base() &&
+                std::vector<Perm>(strong_generators1.begin(),
+                                  strong_generators1.end()) ==
+                std::vector<Perm>(strong_generators2.begin(),
+                                  strong_generators2.end()))
+      << "Random Schreier Sims reproducible ("
+      << num_threads << " threads).";
+  }
+}
+
+TEST(BSGSCachedTransversalsTest, CanConstructBSGSWithSmallTransversalCache)
+{
+  PermSet generators {
+    Perm(12, {{0, 1, 2, 3}}),
+    Perm(12, {{4, 5}, {6, 7}}),
+    Perm(12, {{0, 4, 8}, {1, 5, 9}, {2, 6, 10}, {3, 7, 11}}),
+    Perm(12, {{8, 9, 10}})
+  };
+
+  BSGSOptions bsgs_options;
+  bsgs_options.check_sym = false;
+
+  BSGS bsgs_explicit(generators, &bsgs_options);
+
+  auto cache(std::make_shared<TransversalCache>(
+    4u * TransversalCache::perm_bytes(Perm(12))));
+
+  bsgs_options.transversals = BSGSOptions::Transversals::CACHED;
+  bsgs_options.transversals_cache = cache;
+
+  BSGS bsgs_cached(generators, &bsgs_options);
+
+  EXPECT_EQ(cache, bsgs_cached.transversals_cache())
+    << "BSGS uses given transversal cache.";
+
+  EXPECT_EQ(bsgs_explicit.order(), bsgs_cached.order())
+    << "BSGS with cached transversals has correct order.";
+
+  PermGroup pg(bsgs_explicit);
+
+  for (Perm const &perm : pg) {
+    EXPECT_TRUE(bsgs_cached.strips_completely(perm))
+      << "BSGS with cached transversals correct.";
+  }
+
+  EXPECT_GT(cache->hits() + cache->misses(), 0u)
+    << "Transversal cache used.";
+
+  EXPECT_LE(cache->bytes(), cache->max_bytes())
+    << "Transversal cache does not exceed budget.";
+}
+
+TEST(BSGSBaseChangeTest, CanChangeBaseOfUnsharedCopy)
+{
+  PermSet generators {
+    Perm(8, {{0, 1, 2, 3}}),
+    Perm(8, {{0, 4}, {1, 5}, {2, 6}, {3, 7}})
+  };
+
+  BSGSOptions bsgs_options;
+  bsgs_options.check_sym = false;
+  bsgs_options.transversals = BSGSOptions::Transversals::SCHREIER_TREES;
+
+  BSGS bsgs(generators, &bsgs_options);
+
+  auto base(bsgs.base());
+
+  std::vector<Orbit> orbits;
+  for (unsigned i = 0u; i < bsgs.base_size(); ++i)
+    orbits.push_back(bsgs.orbit(i));
+
+  std::vector<unsigned> prefix {7u, 6u};
+
+  BSGS bsgs_unshared(bsgs.unshared());
+  bsgs_unshared.base_change(prefix);
+
+  EXPECT_TRUE(std::equal(prefix.begin(), prefix.end(),
+                         bsgs_unshared.base().begin()))
+    << "Can change base of unshared copy.";
+
+  EXPECT_EQ(bsgs.order(), bsgs_unshared.order())
+    << "Unshared copy has correct order after base change.";
+
+  ASSERT_EQ(base, bsgs.base())
+    << "Base change of unshared copy leaves base unchanged.";
+
+  for (unsigned i = 0u; i < bsgs.base_size(); ++i) {
+    EXPECT_EQ(orbits[i], bsgs.orbit(i))
+      << "Base change of unshared copy leaves orbits unchanged.";
+  }
+
+  for (Perm const &perm : PermGroup(bsgs)) {
+    EXPECT_TRUE(bsgs.strips_completely(perm))
+      << "Base change of unshared copy leaves BSGS intact.";
+  }
+}
+
+TEST(BSGSSerializationTest, CanSaveAndLoadBSGS)
+{
+  PermSet generators {
+    Perm(12, {{0, 1, 2, 3}}),
+    Perm(12, {{4, 5}, {6, 7}}),
+    Perm(12, {{0, 4, 8}, {1, 5, 9}, {2, 6, 10}, {3, 7, 11}}),
+    Perm(12, {{8, 9, 10}})
+  };
+
+  BSGSOptions bsgs_options;
+  bsgs_options.check_sym = false;
+
+  BSGS bsgs(generators, &bsgs_options);
+
+  std::string file(testing::TempDir() + "bsgs_serialization_test.bsgs");
+
+  bsgs.save(file);
+
+  BSGS bsgs_loaded(BSGS::load(file));
+
+  std::remove(file.c_str());
+
+  EXPECT_EQ(bsgs.degree(), bsgs_loaded.degree())
+    << "Loaded BSGS has correct degree.";
+
+  EXPECT_EQ(bsgs.base(), bsgs_loaded.base())
+    << "Loaded BSGS has correct base.";
+
+  PermSet strong_generators(bsgs.strong_generators());
+  PermSet strong_generators_loaded(bsgs_loaded.strong_generators());
+
+  EXPECT_EQ(std::vector<Perm>(strong_generators.begin(),
+                              strong_generators.end()),
+            std::vector<Perm>(strong_generators_loaded.begin(),
+                              strong_generators_loaded.end()))
+    << "Loaded BSGS has correct strong generators.";
+
+  EXPECT_EQ(bsgs.order(), bsgs_loaded.order())
+    << "Loaded BSGS has correct order.";
+
+  for (unsigned i = 0u; i < bsgs_loaded.base_size(); ++i) {
+    for (unsigned o : bsgs_loaded.orbit(i)) {
+      EXPECT_EQ(o, bsgs_loaded.transversal(i, o)[bsgs_loaded.base_point(i)])
+        << "Loaded BSGS has correct transversals.";
+    }
+  }
+
+  for (Perm const &perm : PermGroup(bsgs)) {
+    EXPECT_TRUE(bsgs_loaded.strips_completely(perm))
+      << "Loaded BSGS correct.";
+  }
+
+  std::vector<unsigned> prefix {11u, 10u};
+
+  bsgs_loaded.base_change(prefix);
+
+  EXPECT_TRUE(std::equal(prefix.begin(), prefix.end(),
+                         bsgs_loaded.base().begin()))
+    << "Can change base of loaded BSGS.";
+
+  EXPECT_EQ(bsgs.order(), bsgs_loaded.order())
+    << "Loaded BSGS has correct order after base change.";
+
+  EXPECT_THROW(BSGS::load(file), std::runtime_error)
+    << "Loading non-existing BSGS file fails.";
+
+  bsgs.save(file, "key");
+
+  EXPECT_EQ(bsgs.base(), BSGS::load(file, "key").base())
+    << "Loading BSGS file with matching key succeeds.";
+
+  EXPECT_THROW(BSGS::load(file, "yek"), std::runtime_error)
+    << "Loading BSGS file with different key fails.";
+
+  EXPECT_THROW(BSGS::load(file), std::runtime_error)
+    << "Loading BSGS file without key fails.";
+
+  std::vector<unsigned> cycle(Perm::SMALL_DEGREE + 6u);
+  std::iota(cycle.begin(), cycle.end(), 0u);
+
+  Perm large_gen(cycle.size(), {cycle});
+
+  BSGS bsgs_large(PermSet {large_gen});
+  bsgs_large.save(file);
+
+  BSGS bsgs_large_loaded(BSGS::load(file));
+
+  EXPECT_EQ(bsgs_large.strong_generators()[0],
+            bsgs_large_loaded.strong_generators()[0])
+    << "Loaded BSGS has correct large strong generators.";
+
+  EXPECT_TRUE(bsgs_large_loaded.strips_completely(large_gen * large_gen))
+    << "Loaded BSGS with large strong generators correct.";
+
+  std::remove(file.c_str());
+}
+
+TEST(BSGSSerializationTest, CanRejectMalformedBSGSFiles)
+{
+  BSGS bsgs(PermSet {Perm(6, {{0, 1, 2}}), Perm(6, {{3, 4, 5}})});
+
+  std::string file(testing::TempDir() + "bsgs_serialization_test.bsgs");
+
+  bsgs.save(file);
+
+  std::vector<uint32_t> words;
+
+  {
+    std::ifstream is(file, std::ios::binary);
+
+    uint32_t word;
+    while (is.read(reinterpret_cast<char *>(&word), sizeof(word)))
+      words.push_back(word);
+  }
+
+  // offsets of the first schreier tree, see BSGS::save
+  unsigned degree = words[5];
+  unsigned num_strong_generators = words[7];
+
+  std::size_t labels =
+    9u + num_strong_generators * degree + bsgs.base_size() + 1u;
+  unsigned num_labels = words[labels - 1u];
+  std::size_t inverse_labels = labels + num_labels * degree;
+  std::size_t edges = inverse_labels + num_labels * degree;
+  std::size_t edge_labels = edges + degree;
+
+  unsigned node = 0u;
+  while (node == bsgs.base_point(0) || words[edges + node] == UINT32_MAX)
+    ++node;
+
+  auto write_words = [&](std::vector<uint32_t> const &words_modified)
+  {
+    std::ofstream os(file, std::ios::binary | std::ios::trunc);
+    os.write(reinterpret_cast<char const *>(words_modified.data()),
+             words_modified.size() * sizeof(uint32_t));
+  };
+
+  auto words_corrupted(words);
+  words_corrupted[labels] = words[labels + 1u];
+  write_words(words_corrupted);
+
+  EXPECT_THROW(BSGS::load(file), std::runtime_error)
+    << "Loading BSGS file with checksum mismatch fails.";
+
+  // malformed files with valid checksums are only detected by verification
+  auto expect_malformed = [&](std::size_t offs,
+                              uint32_t word,
+                              std::string const &what)
+  {
+    auto words_malformed(words);
+    words_malformed[offs] = word;
+
+    uint32_t checksum = 2166136261u;
+    for (std::size_t i = 9u; i < words_malformed.size(); ++i) {
+      checksum ^= words_malformed[i];
+      checksum *= 16777619u;
+    }
+
+    words_malformed[4] = checksum;
+
+    write_words(words_malformed);
+
+    EXPECT_THROW(BSGS::load(file, "", true), std::runtime_error)
+      << "Loading BSGS file with " << what << " fails.";
+  };
+
+  expect_malformed(labels, degree, "invalid label");
+  expect_malformed(inverse_labels, words[inverse_labels + 1u],
+                   "invalid inverse label");
+  expect_malformed(edges + node, degree, "invalid schreier tree edge");
+  expect_malformed(edges + node, node, "cyclic schreier tree");
+  expect_malformed(edge_labels + node, num_labels,
+                   "invalid schreier tree edge label");
+
+  write_words(words);
+
+  EXPECT_NO_THROW(BSGS::load(file, "", true))
+    << "Verifying well-formed BSGS file succeeds.";
+
+  std::remove(file.c_str());
+}
+
 //TEST(BSGSBaseSwapTest, CanConjugateBSGS)
 //{
 //  PermGroup pg(5, {Perm(5, {{1, 2}, {3, 4}}), Perm(5, {{1, 4, 2}})});
@@ -366,10 +366,12 @@ TEST_P(PermGroupConstructionMethodTest, CanGenerateCorrectGroupElements)
 INSTANTIATE_TEST_SUITE_P(ConstructionMethods, PermGroupConstructionMethodTest,
   testing::Combine(
     testing::Values(BSGSOptions::Construction::SCHREIER_SIMS,
-                    BSGSOptions::Construction::SCHREIER_SIMS_RANDOM),
+                    BSGSOptions::Construction::SCHREIER_SIMS_RANDOM,
+                    BSGSOptions::Construction::SCHREIER_SIMS_PARALLEL),
     testing::Values(BSGSOptions::Transversals::EXPLICIT,
-                    BSGSOptions::Transversals::SCHREIER_TREES)));
-                    // TODO: SHALLOW_SCHREIER_TREES
+                    BSGSOptions::Transversals::SCHREIER_TREES,
+                    BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES,
+                    BSGSOptions::Transversals::CACHED)));
 
 TEST(PermGroupCombinationTest, CanConstructDirectProduct)
 {
@@ -0,0 +1,152 @@
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "perm.hpp"
+#include "perm_matrix.hpp"
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+#include "test_utility.hpp"
+
+#include "test_main.cpp"
+
+using namespace mpsym;
+using namespace mpsym::internal;
+
+class PermMatrixTest : public testing::TestWithParam<unsigned>
+{
+protected:
+  Perm random_perm(unsigned degree)
+  {
+    std::vector<unsigned> perm(degree);
+    std::iota(perm.begin(), perm.end(), 0u);
+    std::shuffle(perm.begin(), perm.end(), _re);
+
+    return Perm(perm);
+  }
+
+private:
+  std::mt19937 _re{42u};
+};
+
+TEST_P(PermMatrixTest, CanStorePerms)
+{
+  unsigned degree = GetParam();
+
+  PermSet perms {random_perm(degree), random_perm(degree), Perm(degree)};
+
+  PermMatrix matrix(perms);
+
+  EXPECT_EQ(degree, matrix.degree())
+    << "Permutation matrix has correct degree.";
+
+  EXPECT_EQ(perms.size(), matrix.rows())
+    << "Permutation matrix has correct number of rows.";
+
+  EXPECT_EQ(degree <= 256u ? 1u : degree <= 65536u ? 2u : 4u, matrix.width())
+    << "Permutation matrix uses compact image type.";
+
+  for (unsigned r = 0u; r < perms.size(); ++r) {
+    EXPECT_EQ(perms[r], matrix.get(r))
+      << "Permutation matrix row correct.";
+  }
+
+  EXPECT_FALSE(matrix.id(0u) || matrix.id(1u))
+    << "Non-identity rows recognized.";
+
+  EXPECT_TRUE(matrix.id(2u))
+    << "Identity row recognized.";
+
+  std::vector<unsigned> images(perms[0].vect());
+
+  matrix.set(2u, images.data());
+  EXPECT_EQ(perms[0], matrix.get(2u))
+    << "Storing permutation images works.";
+}
+
+TEST_P(PermMatrixTest, CanComposeAndInvertPerms)
+{
+  unsigned degree = GetParam();
+
+  Perm lhs(random_perm(degree));
+  Perm rhs(random_perm(degree));
+
+  PermMatrix matrix(degree, 3u);
+  matrix.set(0u, lhs);
+  matrix.set(1u, rhs);
+
+  matrix.compose(0u, 1u, 2u);
+  EXPECT_EQ(lhs * rhs, matrix.get(2u))
+    << "Composing permutation matrix rows works.";
+
+  matrix.compose(0u, 1u, 0u);
+  EXPECT_EQ(lhs * rhs, matrix.get(0u))
+    << "Composing permutation matrix rows in place works.";
+
+  matrix.invert(1u, 2u);
+  EXPECT_EQ(~rhs, matrix.get(2u))
+    << "Inverting permutation matrix row works.";
+
+  matrix.set_inverse(2u, lhs);
+  EXPECT_EQ(~lhs, matrix.get(2u))
+    << "Storing inverted permutation works.";
+}
+
+TEST_P(PermMatrixTest, CanDetermineMinimalImages)
+{
+  unsigned degree = GetParam();
+  unsigned offset = 3u;
+
+  std::mt19937 re(1u);
+  std::uniform_int_distribution<unsigned> d(0u, degree + 2u * offset);
+
+  PermSet perms;
+  for (unsigned i = 0u; i < 8u; ++i)
+    perms.insert(random_perm(degree));
+
+  TransposedPermMatrix matrix(perms);
+
+  std::vector<unsigned> candidates;
+
+  for (unsigned i = 0u; i < 20u; ++i) {
+    TaskMapping tasks;
+    for (unsigned j = 0u; j < 10u; ++j)
+      tasks.push_back(i < 10u ? d(re) : j + offset);
+
+    unsigned expected = perms.size();
+    TaskMapping expected_image(tasks);
+
+    for (unsigned c = 0u; c < perms.size(); ++c) {
+      EXPECT_EQ(tasks.less_than(tasks, perms[c], offset),
+                matrix.less_than(c, tasks.data(), tasks.size(), offset))
+        << "Comparison against permuted task mapping correct.";
+
+      if (tasks.less_than(expected_image, perms[c], offset)) {
+        expected = c;
+        expected_image = tasks.permuted(perms[c], offset);
+      }
+    }
+
+    unsigned c = matrix.min_image(tasks.data(), tasks.size(), offset, candidates);
+
+    if (expected == perms.size()) {
+      EXPECT_EQ(perms.size(), c)
+        << "Absence of smaller image recognized.";
+    } else {
+      ASSERT_LT(c, perms.size())
+        << "Presence of smaller image recognized.";
+
+      TaskMapping image(tasks);
+      matrix.permute(c, image.data(), image.size(), offset);
+
+      EXPECT_EQ(expected_image, image)
+        << "Minimal image determined correctly.";
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(PermMatrixDegrees,
+                         PermMatrixTest,
+                         testing::Values(5u, 67u, 300u, 70000u));
@@ -1,5 +1,6 @@
 #include <sstream>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -196,3 +197,67 @@ TEST(PermTest, CanRestrictPerm)
       << "Restricting permutation yields correct result.";
   }
 }
+
+TEST(PermTest, CanHandleLargePerms)
+{
+  unsigned const degree = Perm::SMALL_DEGREE + 36u;
+
+  Perm perm(degree, {{0, Perm::SMALL_DEGREE - 1u, degree - 1u}, {1, 70}});
+
+  EXPECT_EQ(degree, perm.degree())
+    << "Large permutation has correct degree.";
+
+  EXPECT_EQ(degree - 1u, perm[Perm::SMALL_DEGREE - 1u])
+    << "Large permutation has correct images.";
+
+  std::vector<std::vector<unsigned>> expected_cycles {
+    {0, Perm::SMALL_DEGREE - 1u, degree - 1u}, {1, 70}};
+
+  EXPECT_EQ(expected_cycles, perm.cycles())
+    << "Large permutation has correct cycles.";
+
+  EXPECT_TRUE((perm * ~perm).id())
+    << "Inverting and multiplying large permutation works.";
+
+  Perm perm_extended(Perm(5, {{0, 4}}).extended(degree));
+
+  EXPECT_EQ(Perm(degree, {{0, 4}}), perm_extended)
+    << "Extending small permutation past inline storage works.";
+
+  EXPECT_EQ(Perm(2, {{0, 1}}),
+            Perm(degree, {{degree - 2u, degree - 1u}}).normalized(degree - 2u,
+                                                                 degree - 1u))
+    << "Normalizing large permutation to small permutation works.";
+
+  Perm perm_assigned(perm);
+  perm_assigned = Perm(3, {{0, 1}});
+
+  EXPECT_EQ(Perm(3, {{0, 1}}), perm_assigned)
+    << "Assigning small permutation to large permutation works.";
+
+  perm_assigned = perm;
+
+  EXPECT_EQ(perm, perm_assigned)
+    << "Assigning large permutation to small permutation works.";
+
+  Perm perm_moved(std::move(perm_assigned));
+  perm_assigned = std::move(perm_moved);
+
+  EXPECT_EQ(perm, perm_assigned)
+    << "Moving large permutations works.";
+
+  std::vector<unsigned> images(perm.vect());
+
+  Perm perm_borrowed(Perm::borrowed(degree, images.data()));
+
+  EXPECT_EQ(perm, perm_borrowed)
+    << "Borrowing large permutation images works.";
+
+  perm_borrowed *= perm;
+
+  EXPECT_EQ(perm * perm, perm_borrowed)
+    << "Multiplying permutation with borrowed images works.";
+
+  EXPECT_EQ(perm.vect(), images)
+    << "Multiplying permutation with borrowed images leaves them unchanged.";
+}
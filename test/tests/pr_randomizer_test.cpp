@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <memory>
+#include <random>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -79,6 +80,19 @@ TEST_F(PRRandomizerTest, DistributionApproximatelyUniform)
   }
 }
 
+TEST_F(PRRandomizerTest, SeededRandomizersReproducible)
+{
+  PermSet generators {Perm(4, {{1, 3}}), Perm(4, {{0, 1}, {2, 3}})};
+
+  PrRandomizer pr1(generators, std::mt19937(42u));
+  PrRandomizer pr2(generators, std::mt19937(42u));
+
+  for (int j = 0; j < RANDOMIZER_RUNS; ++j) {
+    ASSERT_EQ(pr1.next(), pr2.next())
+      << "Equally seeded randomizers produce same elements.";
+  }
+}
+
 TEST_F(PRRandomizerTest, CanTestForAltSym)
 {
   auto symmetric_generators = [](unsigned n) {
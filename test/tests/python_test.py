@@ -1,4 +1,6 @@
+import os
 import pickle
+import tempfile
 import unittest
 from copy import deepcopy
 from itertools import cycle, permutations
@@ -200,9 +202,107 @@ class ArchGraphSystemTest(unittest.TestCase):
     def test_representative(self):
         for orbit in [self.ag_orbit1, self.ag_orbit2]:
             for mapping in orbit:
-                for method in 'iterate', 'orbit':
+                for method in 'iterate', 'orbit', 'backtrack':
                     self.assertEqual(self.ag.representative(mapping, method=method), orbit[0])
 
+    def test_representatives(self):
+        mappings = self.ag_orbit1 + self.ag_orbit2
+        expected = [self.ag_orbit1[0]] * len(self.ag_orbit1) + \
+                   [self.ag_orbit2[0]] * len(self.ag_orbit2)
+
+        for num_threads in 1, 4:
+            self.assertEqual(self.ag.representatives(mappings, num_threads=num_threads),
+                             expected)
+
+            representatives = mp.Representatives()
+            reprs = self.ag.representatives(mappings,
+                                            representatives,
+                                            num_threads=num_threads)
+
+            self.assertEqual([repr_ for repr_, _ in reprs], expected)
+            self.assertEqual(len(representatives), 2)
+
+    def test_representatives_memo(self):
+        mappings = self.ag_orbit1 + self.ag_orbit2
+
+        representatives = mp.Representatives()
+        representatives.memo_capacity = 100
+
+        for _ in range(2):
+            for mapping in mappings:
+                self.ag.representative(mapping, representatives)
+
+        stats = representatives.memo_stats()
+
+        self.assertEqual(stats['capacity'], 100)
+        self.assertEqual(stats['size'], len(mappings))
+        self.assertEqual(stats['hits'], len(mappings))
+        self.assertEqual(stats['misses'], len(mappings))
+        self.assertEqual(stats['evictions'], 0)
+
+    def test_representatives_numpy(self):
+        try:
+            import numpy as np
+        except ImportError:
+            self.skipTest("numpy not available")
+
+        mappings = self.ag_orbit1 + self.ag_orbit2
+        expected = [self.ag_orbit1[0]] * len(self.ag_orbit1) + \
+                   [self.ag_orbit2[0]] * len(self.ag_orbit2)
+
+        for dtype in np.uint32, np.int64:
+            mappings_array = np.array(mappings, dtype=dtype)
+
+            for num_threads in 1, 4:
+                reprs = self.ag.representatives(mappings_array,
+                                                num_threads=num_threads)
+
+                self.assertEqual(reprs.dtype, np.uint32)
+                self.assertEqual(reprs.tolist(), [list(e) for e in expected])
+
+                representatives = mp.Representatives()
+                reprs, orbit_indices = self.ag.representatives(mappings_array,
+                                                               representatives,
+                                                               num_threads=num_threads)
+
+                self.assertEqual(reprs.tolist(), [list(e) for e in expected])
+                self.assertEqual(len(set(orbit_indices.tolist())), 2)
+                self.assertEqual(len(representatives), 2)
+
+    def test_representatives_mapping_file(self):
+        mappings = self.ag_orbit1 + self.ag_orbit2
+        expected = [self.ag_orbit1[0]] * len(self.ag_orbit1) + \
+                   [self.ag_orbit2[0]] * len(self.ag_orbit2)
+
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            file = os.path.join(tmp_dir, 'mappings.tmf')
+
+            mp.MappingFile.save(file, mappings)
+
+            self.assertTrue(mp.MappingFile.is_mapping_file(file))
+
+            mapping_file = mp.MappingFile(file)
+
+            self.assertEqual(len(mapping_file), len(mappings))
+            self.assertEqual(mapping_file.num_tasks, len(mappings[0]))
+            self.assertEqual(list(mapping_file), mappings)
+            self.assertEqual(mapping_file[-1], mappings[-1])
+
+            for num_threads in 1, 4:
+                reprs = self.ag.representatives(mapping_file,
+                                                num_threads=num_threads)
+
+                self.assertEqual(reprs.tolist(), [list(e) for e in expected])
+
+                representatives = mp.Representatives()
+                reprs, orbit_indices = self.ag.representatives(mapping_file,
+                                                               representatives,
+                                                               num_threads=num_threads)
+
+                self.assertEqual(reprs.tolist(), [list(e) for e in expected])
+                self.assertEqual(len(set(orbit_indices.tolist())), 2)
+                self.assertEqual(len(representatives), 2)
+
     def test_orbit(self):
         for orbit in [self.ag_orbit1, self.ag_orbit2]:
             self.assertCountEqual(list(self.ag.orbit(orbit[0])), orbit)
@@ -215,6 +315,7 @@ class ArchGraphSystemTest(unittest.TestCase):
           ag = mp.ArchGraphAutomorphisms(Sn)
 
           self.assertEqual(orbit_len(ag.orbit(range(n))), factorial(n))
+          self.assertEqual(len(ag.orbit(range(n))), factorial(n))
 
     def test_from_nauty(self):
         vertices_super = 4
@@ -1,14 +1,19 @@
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include "gmock/gmock.h"
 
+#include "cached_transversals.hpp"
 #include "explicit_transversals.hpp"
+#include "mapped_schreier_tree.hpp"
 #include "orbit.hpp"
 #include "perm.hpp"
 #include "perm_set.hpp"
 #include "schreier_tree.hpp"
+#include "shallow_schreier_tree.hpp"
 
 #include "test_main.cpp"
 
@@ -21,7 +26,8 @@ template <typename T>
 class SchreierStructureTest : public testing::Test {};
 
 using SchreierStructureTypes = ::testing::Types<ExplicitTransversals,
-                                                SchreierTree>;
+                                                SchreierTree,
+                                                ShallowSchreierTree>;
 
 TYPED_TEST_SUITE(SchreierStructureTest, SchreierStructureTypes,);
 
@@ -89,6 +95,157 @@ TYPED_TEST(SchreierStructureTest, CanConstructSchreierStructures)
       EXPECT_EQ(origin, transv[root])
         << "Transversal " << transv << " correct "
         << "(root is " << root << ", origin is " << origin << ").";
+
+      std::vector<unsigned> points(n);
+      std::iota(points.begin(), points.end(), 0u);
+
+      schreier_structure->transversal_apply_inverse(
+        origin, points.data(), points.data() + n);
+
+      EXPECT_EQ((~transv).vect(), points)
+        << "Inverse transversal applied correctly "
+        << "(root is " << root << ", origin is " << origin << ").";
     }
   }
 }
+
+TEST(ShallowSchreierTreeTest, ShallowSchreierTreeHasLogarithmicDepth)
+{
+  unsigned n = 256;
+
+  std::vector<unsigned> cycle(n);
+  std::iota(cycle.begin(), cycle.end(), 0u);
+
+  PermSet generators {Perm(n, {cycle})};
+  generators.insert_inverses();
+
+  auto schreier_tree(std::make_shared<ShallowSchreierTree>(n, 0u, generators));
+
+  Orbit::generate(0u, generators, schreier_tree);
+
+  EXPECT_LE(schreier_tree->depth(), 16u)
+    << "Shallow Schreier tree has logarithmic depth.";
+
+  for (unsigned x = 0u; x < n; ++x) {
+    EXPECT_EQ(x, schreier_tree->transversal(x)[0u])
+      << "Transversal correct (origin is " << x << ").";
+  }
+}
+
+TEST(SchreierTreeTest, SchreierTreeTracksWordLengths)
+{
+  unsigned n = 8;
+
+  // the orbit graph and thus the schreier tree is a path
+  PermSet generators;
+  for (unsigned i = 0u; i < n - 1u; ++i)
+    generators.insert(Perm(n, {{i, i + 1u}}));
+
+  auto schreier_tree(std::make_shared<SchreierTree>(n, 0u, generators));
+
+  Orbit::generate(0u, generators, schreier_tree);
+
+  for (unsigned x = 0u; x < n; ++x) {
+    EXPECT_EQ(x, schreier_tree->word_length(x))
+      << "Word length correct (origin is " << x << ").";
+  }
+}
+
+TEST(MappedSchreierTreeTest, CanModifyMappedSchreierTrees)
+{
+  uint32_t labels[] = {1, 2, 3, 0, 5, 4};
+  uint32_t inverse_labels[] = {3, 0, 1, 2, 5, 4};
+  uint32_t edges[] = {0, 0, 1, 2,
+                      MappedSchreierTree::NO_EDGE, MappedSchreierTree::NO_EDGE};
+  uint32_t edge_labels[] = {MappedSchreierTree::NO_EDGE, 0, 0, 0,
+                            MappedSchreierTree::NO_EDGE, MappedSchreierTree::NO_EDGE};
+
+  MappedSchreierTree mst(
+    6, 0, 1, labels, inverse_labels, edges, edge_labels, nullptr);
+
+  std::vector<Perm> transversals;
+  for (unsigned x = 0u; x < 4u; ++x)
+    transversals.push_back(mst.transversal(x));
+
+  for (unsigned x = 0u; x < 4u; ++x) {
+    std::vector<unsigned> points {0u, 1u, 2u, 3u, 4u, 5u};
+    mst.transversal_apply_inverse(x, points.data(), points.data() + 6);
+
+    EXPECT_EQ((~transversals[x]).vect(), points)
+      << "Can apply inverted transversals of mapped schreier tree.";
+  }
+
+  mst.add_label(Perm(6, {{4, 5}}));
+
+  EXPECT_EQ(2u, mst.labels().size())
+    << "Can add labels to mapped schreier tree.";
+
+  EXPECT_THAT(mst.nodes(), UnorderedElementsAreArray({0u, 1u, 2u, 3u}))
+    << "Nodes of mapped schreier tree preserved after modification.";
+
+  for (unsigned x = 0u; x < 4u; ++x) {
+    EXPECT_EQ(transversals[x], mst.transversal(x))
+      << "Transversals of mapped schreier tree preserved after modification.";
+  }
+
+  EXPECT_FALSE(mst.contains(4u))
+    << "Mapped schreier tree does not contain unmapped nodes.";
+}
+
+TEST(CachedTransversalsTest, CanCacheTransversals)
+{
+  unsigned n = 100;
+
+  std::vector<unsigned> cycle(n);
+  std::iota(cycle.begin(), cycle.end(), 0u);
+
+  PermSet generators {Perm(n, {cycle})};
+  generators.insert_inverses();
+
+  // large enough for exactly ten transversals
+  auto cache(std::make_shared<TransversalCache>(
+    10u * TransversalCache::perm_bytes(Perm(n))));
+
+  auto cached_transversals(
+    std::make_shared<CachedTransversals>(n, 0u, generators, cache));
+
+  Orbit::generate(0u, generators, cached_transversals);
+
+  for (unsigned x = 1u; x <= 10u; ++x)
+    cached_transversals->transversal(x);
+
+  EXPECT_EQ(0u, cache->hits())
+    << "No cache hits for previously unseen transversals.";
+
+  EXPECT_EQ(10u, cache->misses())
+    << "Cache misses for previously unseen transversals.";
+
+  EXPECT_EQ(10u, cache->size())
+    << "Transversals cached.";
+
+  for (unsigned x = 1u; x <= 10u; ++x)
+    cached_transversals->transversal(x);
+
+  EXPECT_EQ(10u, cache->hits())
+    << "Cache hits for previously seen transversals.";
+
+  for (unsigned x = 11u; x <= 15u; ++x)
+    cached_transversals->transversal(x);
+
+  EXPECT_EQ(10u, cache->size())
+    << "Cache size does not exceed budget.";
+
+  EXPECT_LE(cache->bytes(), cache->max_bytes())
+    << "Cache memory usage does not exceed budget.";
+
+  for (unsigned x = 6u; x <= 15u; ++x)
+    cached_transversals->transversal(x);
+
+  EXPECT_EQ(20u, cache->hits())
+    << "Least recently used transversals evicted.";
+
+  for (unsigned x = 0u; x < n; ++x) {
+    EXPECT_EQ(x, cached_transversals->transversal(x)[0u])
+      << "Transversal correct (origin is " << x << ").";
+  }
+}
@@ -0,0 +1,126 @@
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "task_mapping.hpp"
+#include "task_mapping_file.hpp"
+
+#include "test_main.cpp"
+
+using namespace mpsym;
+
+using testing::ElementsAreArray;
+
+namespace
+{
+
+std::vector<TaskMapping> iterate_view(TaskMappingView const &view)
+{
+  std::vector<TaskMapping> res;
+  for (std::size_t i = 0u; i < view.size(); ++i)
+    res.push_back(view[i]);
+
+  return res;
+}
+
+} // anonymous namespace
+
+TEST(TaskMappingFileTest, CanSaveAndLoadTaskMappings)
+{
+  std::string file(testing::TempDir() + "task_mapping_file_test.tmf");
+
+  for (unsigned num_processors : {10u, 1000u, 100000u}) {
+    std::vector<TaskMapping> mappings;
+    for (unsigned i = 0u; i < 100u; ++i)
+      mappings.push_back({(7u * i) % num_processors,
+                          (i * i) % num_processors,
+                          num_processors - 1u});
+
+    unsigned expected_task_bytes = num_processors <= 256u ? 1u :
+                                   num_processors <= 65536u ? 2u : 4u;
+
+    TaskMappingView::save(file, mappings.data(), mappings.size());
+
+    TaskMappingView view(file);
+
+    ASSERT_TRUE(TaskMappingView::is_task_mapping_file(file))
+      << "Task mapping file recognized (" << num_processors << " processors).";
+
+    EXPECT_TRUE(view.size() == mappings.size() &&
+                view.num_tasks() == 3u &&
+                view.num_processors() == num_processors &&
+                view.task_bytes() == expected_task_bytes)
+      << "Task mapping file header correct (" << num_processors << " processors).";
+
+    EXPECT_THAT(iterate_view(view), ElementsAreArray(mappings))
+      << "Task mappings loaded correctly (" << num_processors << " processors).";
+
+    EXPECT_EQ(mappings[42][1], view.task(42u, 1u))
+      << "Single tasks accessible (" << num_processors << " processors).";
+
+    auto slice(view.slice(10u, 20u));
+
+    EXPECT_THAT(iterate_view(slice),
+                ElementsAreArray(mappings.begin() + 10, mappings.begin() + 30))
+      << "Task mapping slices correct (" << num_processors << " processors).";
+
+    std::vector<unsigned> mappings_flat;
+    for (auto const &mapping : mappings)
+      mappings_flat.insert(mappings_flat.end(), mapping.begin(), mapping.end());
+
+    TaskMappingView::save_flat(file,
+                               mappings_flat.data(),
+                               mappings.size(),
+                               3u,
+                               num_processors);
+
+    EXPECT_THAT(iterate_view(TaskMappingView(file)), ElementsAreArray(mappings))
+      << "Flat task mappings saved correctly (" << num_processors << " processors).";
+  }
+
+  std::remove(file.c_str());
+}
+
+TEST(TaskMappingFileTest, RejectsMalformedFiles)
+{
+  std::string file(testing::TempDir() + "task_mapping_file_test_malformed.tmf");
+
+  std::vector<TaskMapping> mappings {{0u, 1u}, {1u, 2u}};
+
+  EXPECT_THROW(TaskMappingView::save(file, mappings.data(), mappings.size(), 2u),
+               std::invalid_argument)
+    << "Tasks exceeding the number of processors rejected.";
+
+  TaskMappingView::save(file, mappings.data(), mappings.size());
+
+  // truncate the last mapping
+  std::ifstream is(file, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(is)),
+                      std::istreambuf_iterator<char>());
+  is.close();
+
+  std::ofstream os(file, std::ios::binary | std::ios::trunc);
+  os.write(content.data(), content.size() - 1u);
+  os.close();
+
+  EXPECT_THROW(TaskMappingView view(file), std::runtime_error)
+    << "Truncated task mapping file rejected.";
+
+  std::ofstream os_text(file, std::ios::trunc);
+  os_text << "0 1\n1 2\n";
+  os_text.close();
+
+  EXPECT_FALSE(TaskMappingView::is_task_mapping_file(file))
+    << "Text files not recognized as task mapping files.";
+
+  EXPECT_THROW(TaskMappingView view(file), std::runtime_error)
+    << "Text files rejected.";
+
+  std::remove(file.c_str());
+}
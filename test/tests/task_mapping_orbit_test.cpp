@@ -0,0 +1,258 @@
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_memo.hpp"
+#include "task_mapping_orbit.hpp"
+#include "task_mapping_orbit_enumerator.hpp"
+
+#include "test_main.cpp"
+
+using namespace mpsym;
+using namespace mpsym::internal;
+
+using testing::ElementsAreArray;
+using testing::UnorderedElementsAreArray;
+
+namespace
+{
+
+std::vector<TaskMapping> iterate_orbit(TMO const &orbit)
+{
+  std::vector<TaskMapping> res;
+  for (auto const &mapping : orbit)
+    res.push_back(mapping);
+
+  return res;
+}
+
+TaskMapping long_mapping(unsigned length, unsigned num_tasks)
+{
+  TaskMapping res;
+  for (unsigned i = 0u; i < length; ++i)
+    res.push_back((i * i) % num_tasks);
+
+  return res;
+}
+
+} // anonymous namespace
+
+TEST(TMOTest, CanEnumerateOrbits)
+{
+  PermSet generators {
+    Perm(6, {{0, 1}}),
+    Perm(6, {{0, 1, 2, 3, 4, 5}})
+  };
+
+  TaskMapping root {0, 1, 2, 3};
+
+  TMO orbit(root, generators);
+
+  auto expected(iterate_orbit(orbit));
+
+  ASSERT_EQ(360u, expected.size())
+    << "Iterating over orbit yields all mappings.";
+
+  for (unsigned num_threads : {1u, 4u}) {
+    for (uint64_t max_bitmap_bits : {TMOEnumerator::DEFAULT_MAX_BITMAP_BITS,
+                                     static_cast<uint64_t>(0u)}) {
+      TMOEnumerator enumerator(root, generators, num_threads, max_bitmap_bits);
+
+      EXPECT_EQ(expected.size(), enumerator.size())
+        << "Orbit size determined correctly ("
+        << num_threads << " threads, max bitmap bits: " << max_bitmap_bits << ").";
+
+      EXPECT_THAT(enumerator.mappings(), UnorderedElementsAreArray(expected))
+        << "Orbit enumerated correctly ("
+        << num_threads << " threads, max bitmap bits: " << max_bitmap_bits << ").";
+    }
+  }
+}
+
+TEST(TMOTest, CanEnumerateOrbitsOfLongMappings)
+{
+  PermSet generators {
+    Perm(16, {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}}),
+    Perm(16, {{0, 15}, {1, 14}, {2, 13}, {3, 12}, {4, 11}, {5, 10}, {6, 9}, {7, 8}})
+  };
+
+  // 16^20 = 2^80 and 16^40 = 2^160 possible mappings
+  for (unsigned length : {20u, 40u}) {
+    TaskMapping root(long_mapping(length, 16u));
+
+    TaskMappingRanking ranking(root, generators);
+
+    EXPECT_EQ(length == 20u ? 2u : 0u, ranking.words())
+      << "Rank size determined correctly.";
+
+    if (ranking.words() > 0u) {
+      EXPECT_EQ(root, ranking.unrank(ranking.rank(root)))
+        << "Ranking of long mapping reversible.";
+    }
+
+    TMO orbit(root, generators);
+
+    auto expected(iterate_orbit(orbit));
+
+    ASSERT_EQ(32u, expected.size())
+      << "Iterating over orbit yields all mappings.";
+
+    EXPECT_EQ(expected.size(), orbit.size(4u))
+      << "Orbit size determined correctly.";
+
+    EXPECT_THAT(orbit.mappings(4u), UnorderedElementsAreArray(expected))
+      << "Orbit enumerated correctly.";
+  }
+}
+
+TEST(TMORsTest, CanStoreRepresentativesConcurrently)
+{
+  // all mappings of four tasks onto ten processors
+  std::vector<TaskMapping> mappings;
+  for (unsigned i = 0u; i < 10000u; ++i)
+    mappings.push_back({i % 10u, (i / 10u) % 10u, (i / 100u) % 10u, i / 1000u});
+
+  for (bool spill : {false, true}) {
+    TMORs orbits(spill ? testing::TempDir() : "");
+
+    std::vector<std::vector<unsigned>> classes(4u);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0u; t < 4u; ++t) {
+      threads.emplace_back([&, t]{
+        for (auto const &mapping : mappings)
+          classes[t].push_back(orbits.insert(mapping).second);
+      });
+    }
+
+    for (auto &thread : threads)
+      thread.join();
+
+    EXPECT_EQ(mappings.size(), orbits.num_orbits())
+      << "Number of representatives correct (spill: " << spill << ").";
+
+    for (unsigned t = 1u; t < 4u; ++t) {
+      EXPECT_THAT(classes[t], ElementsAreArray(classes[0]))
+        << "Equivalence classes consistent across threads (spill: " << spill << ").";
+    }
+
+    std::set<unsigned> class_set(classes[0].begin(), classes[0].end());
+
+    EXPECT_TRUE(class_set.size() == mappings.size() &&
+                *class_set.rbegin() == mappings.size() - 1u)
+      << "Equivalence classes dense (spill: " << spill << ").";
+
+    std::vector<TaskMapping> reprs;
+    for (auto const &repr : orbits)
+      reprs.push_back(repr);
+
+    EXPECT_THAT(reprs, UnorderedElementsAreArray(mappings))
+      << "Representatives iterable (spill: " << spill << ").";
+
+    EXPECT_TRUE(orbits.is_repr(TaskMapping {1u, 2u, 3u, 4u}) &&
+                !orbits.is_repr(TaskMapping {1u, 2u, 3u, 10u}) &&
+                !orbits.is_repr(TaskMapping {1u, 2u, 3u}))
+      << "Representatives looked up correctly (spill: " << spill << ").";
+
+    TMORs orbits_copy(orbits);
+
+    EXPECT_TRUE(orbits_copy == orbits &&
+                orbits_copy.insert(mappings[42]).second == classes[0][42])
+      << "Representatives copied correctly (spill: " << spill << ").";
+  }
+}
+
+TEST(TaskMappingMemoTest, CanEvictMappings)
+{
+  TaskMappingMemo memo(2u, 1u);
+
+  TaskMapping a {0u, 1u}, b {1u, 0u}, c {1u, 1u};
+  TaskMapping repr;
+  unsigned orbit_index;
+
+  memo.insert(a, 0u, a, 0u);
+  memo.insert(b, 0u, a, 0u);
+
+  ASSERT_TRUE(memo.lookup(a, 0u, repr, orbit_index) && repr == a && orbit_index == 0u)
+    << "Memoized mapping found.";
+
+  memo.insert(c, 0u, c, 1u);
+
+  EXPECT_EQ(2u, memo.size())
+    << "Memo size bounded.";
+
+  EXPECT_TRUE(memo.lookup(a, 0u, repr, orbit_index) &&
+              !memo.lookup(b, 0u, repr, orbit_index) &&
+              memo.lookup(c, 0u, repr, orbit_index) && repr == c && orbit_index == 1u)
+    << "Least recently referenced mapping evicted.";
+
+  auto stats(memo.stats());
+
+  EXPECT_TRUE(stats.hits == 3u && stats.misses == 1u && stats.evictions == 1u)
+    << "Memo statistics correct.";
+}
+
+TEST(TaskMappingMemoTest, CanDistinguishTags)
+{
+  TaskMappingMemo memo(4u, 1u);
+
+  TaskMapping a {0u, 1u}, b {1u, 0u};
+  TaskMapping repr;
+  unsigned orbit_index;
+
+  memo.insert(a, 0u, a, 0u);
+
+  EXPECT_FALSE(memo.lookup(a, 1u, repr, orbit_index))
+    << "Mapping memoized under different tag not found.";
+
+  memo.insert(a, 1u, b, 1u);
+
+  EXPECT_TRUE(memo.lookup(a, 0u, repr, orbit_index) && repr == a && orbit_index == 0u &&
+              memo.lookup(a, 1u, repr, orbit_index) && repr == b && orbit_index == 1u)
+    << "Same mapping memoized separately under different tags.";
+}
+
+TEST(TMORsTest, CopiesStartWithEmptyMemo)
+{
+  TMORs orbits;
+  orbits.set_memo_capacity(16u);
+
+  orbits.memo()->insert({0u, 1u}, 0u, {0u, 1u}, orbits.insert({0u, 1u}).second);
+
+  TMORs orbits_copy(orbits);
+
+  EXPECT_TRUE(orbits_copy.memo_capacity() == 16u && orbits_copy.memo()->size() == 0u)
+    << "Memo capacity copied, memo contents not copied.";
+}
+
+TEST(TMORsTest, MovesKeepMemo)
+{
+  TMORs orbits;
+  orbits.set_memo_capacity(16u);
+
+  orbits.memo()->insert({0u, 1u}, 0u, {0u, 1u}, orbits.insert({0u, 1u}).second);
+
+  TMORs orbits_moved(std::move(orbits));
+
+  EXPECT_TRUE(orbits_moved.num_orbits() == 1u &&
+              orbits_moved.is_repr({0u, 1u}) &&
+              orbits_moved.memo_capacity() == 16u &&
+              orbits_moved.memo()->size() == 1u)
+    << "Move construction keeps representatives and memo.";
+
+  TMORs orbits_assigned;
+  orbits_assigned = std::move(orbits_moved);
+
+  EXPECT_TRUE(orbits_assigned.num_orbits() == 1u &&
+              orbits_assigned.is_repr({0u, 1u}) &&
+              orbits_assigned.memo_capacity() == 16u &&
+              orbits_assigned.memo()->size() == 1u)
+    << "Move assignment keeps representatives and memo.";
+}
@@ -81,4 +81,62 @@ TEST(TimeoutTest, CanTimeoutFunction)
   wait_for_timed_out_threads();
 }
 
+TEST(TimeoutTest, CanRunAbortableFunctionsOnCallingThread)
+{
+  auto caller(std::this_thread::get_id());
+
+  unsigned num_calls = 0u;
+
+  for (unsigned i = 0u; i < 10000u; ++i) {
+    num_calls += run_abortable_with_timeout(
+      "on_caller",
+      ms(1000),
+      [&](flag aborted)
+      { return std::this_thread::get_id() == caller && !is_set(aborted); });
+  }
+
+  EXPECT_EQ(10000u, num_calls)
+    << "Abortable functions executed on calling thread.";
+
+  EXPECT_THAT(
+    [&]() {
+      run_abortable_with_timeout(
+        "not_aborted",
+        ms(1000),
+        [&](flag) -> int { throw AbortedError("not_aborted"); });
+    },
+    testing::ThrowsMessage<AbortedError>("not_aborted aborted"))
+      << "Abort without timeout is not reported as timeout.";
+}
+
+TEST(TimeoutTest, CanTimeoutNonCooperativeFunction)
+{
+  std::atomic<bool> non_cooperative_aborted(false);
+
+  auto start(std::chrono::steady_clock::now());
+
+  EXPECT_THAT(
+    [&]() {
+      run_abortable_with_timeout_threaded(
+        "non_cooperative",
+        ms(100),
+        [&](flag aborted)
+        {
+          sleep(ms(500));
+          non_cooperative_aborted = is_set(aborted);
+          return 42;
+        });
+    },
+    testing::ThrowsMessage<TimeoutError>("non_cooperative timeout"))
+      << "Non-cooperative function timeout yields exception.";
+
+  EXPECT_LT(std::chrono::steady_clock::now() - start, ms(400))
+    << "Non-cooperative function timeout does not wait for function.";
+
+  wait_for_timed_out_threads();
+
+  EXPECT_TRUE(non_cooperative_aborted)
+    << "Abort flag of timed out non-cooperative function set.";
+}
+
 } // anonymous namespace